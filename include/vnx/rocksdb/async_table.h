@@ -0,0 +1,285 @@
+/*
+ * async_table.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#ifndef INCLUDE_VNX_ROCKSDB_ASYNC_TABLE_H_
+#define INCLUDE_VNX_ROCKSDB_ASYNC_TABLE_H_
+
+#include <vnx/rocksdb/table.h>
+#include <vnx/rocksdb/multi_table.h>
+
+#include <vnx/ThreadPool.h>
+
+#include <mutex>
+#include <memory>
+#include <condition_variable>
+#include <stdexcept>
+
+
+namespace vnx {
+namespace rocksdb {
+
+typedef std::function<void(const std::function<void()>&)> executor_t;
+typedef std::function<void(const std::exception&)> error_callback_t;
+
+/*
+ * Dedicated I/O thread pool for lookups, so that event loop threads are not blocked by disk reads.
+ * One pool is meant to be shared by all async tables of a process.
+ * Results are passed to `executor` (for example to post them to an event loop),
+ * if `executor` is empty callbacks are called on the I/O thread.
+ * Every request results in exactly one call of either its callback or its (mandatory) error callback.
+ */
+class async_pool {
+public:
+	executor_t executor;
+
+	async_pool(const int num_threads = 8)
+		:	threads(num_threads)
+	{
+	}
+
+	~async_pool() {
+		threads.close();
+	}
+
+	template<typename R>
+	void post(	const std::function<R()>& func,
+				const std::function<void(const R&)>& callback,
+				const error_callback_t& error_callback) const
+	{
+		if(!callback || !error_callback) {
+			throw std::logic_error("async_pool::post(): callback and error_callback are required");
+		}
+		const auto executor = this->executor;
+		threads.add_task([func, callback, error_callback, executor]() {
+			std::function<void()> result;
+			try {
+				const auto value = std::make_shared<R>(func());
+				result = [callback, value]() {
+					callback(*value);
+				};
+			} catch(const std::exception& ex) {
+				const auto error = std::make_shared<std::runtime_error>(ex.what());
+				result = [error_callback, error]() {
+					error_callback(*error);
+				};
+			} catch(...) {
+				const auto error = std::make_shared<std::runtime_error>("unknown exception");
+				result = [error_callback, error]() {
+					error_callback(*error);
+				};
+			}
+			if(executor) {
+				executor(result);
+			} else {
+				result();
+			}
+		});
+	}
+
+private:
+	mutable vnx::ThreadPool threads;
+
+};
+
+/*
+ * Tracks the lookups of one table which are still queued or running on a shared async_pool,
+ * the destructor waits for them, so the table is not closed while they access it.
+ */
+class async_tasks {
+public:
+	~async_tasks() {
+		wait();
+	}
+
+	template<typename R>
+	void post(	const async_pool& pool,
+				const std::function<R()>& func,
+				const std::function<void(const R&)>& callback,
+				const error_callback_t& error_callback)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			num_pending++;
+		}
+		try {
+			pool.post<R>(
+				[this, func]() -> R {
+					const finish_t done(this);
+					return func();
+				},
+				callback, error_callback);
+		} catch(...) {
+			finish();
+			throw;
+		}
+	}
+
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		signal.wait(lock, [this]() { return num_pending == 0; });
+	}
+
+private:
+	struct finish_t {
+		async_tasks* tasks;
+		finish_t(async_tasks* tasks) : tasks(tasks) {}
+		~finish_t() {
+			tasks->finish();
+		}
+	};
+
+	void finish()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		num_pending--;
+		signal.notify_all();
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable signal;
+	size_t num_pending = 0;
+
+};
+
+
+template<typename K, typename V>
+class async_table : public table<K, V> {
+private:
+	typedef table<K, V> super_t;
+
+public:
+	async_table(std::shared_ptr<const async_pool> pool)
+		:	pool(pool)
+	{
+		if(!pool) {
+			throw std::logic_error("async_table(): pool == nullptr");
+		}
+	}
+
+	async_table(std::shared_ptr<const async_pool> pool, const std::string& file_path, const ::rocksdb::Options& options = ::rocksdb::Options())
+		:	async_table(pool)
+	{
+		super_t::open(file_path, options);
+	}
+
+	void async_find(const K& key,
+					const std::function<void(bool, const V&)>& callback,
+					const error_callback_t& error_callback) const
+	{
+		tasks.post<std::pair<bool, V>>(
+			*pool, [this, key]() {
+				std::pair<bool, V> out;
+				out.first = super_t::find(key, out.second);
+				return out;
+			},
+			[callback](const std::pair<bool, V>& result) {
+				callback(result.first, result.second);
+			},
+			error_callback);
+	}
+
+	/*
+	 * Looks up all `keys` with a single MultiGet.
+	 */
+	void async_find_many(	const std::vector<K>& keys,
+							const std::function<void(const std::vector<V>&, const std::vector<bool>&)>& callback,
+							const error_callback_t& error_callback) const
+	{
+		tasks.post<std::pair<std::vector<V>, std::vector<bool>>>(
+			*pool, [this, keys]() {
+				std::pair<std::vector<V>, std::vector<bool>> out;
+				super_t::find_many(keys, out.first, out.second);
+				return out;
+			},
+			[callback](const std::pair<std::vector<V>, std::vector<bool>>& result) {
+				callback(result.first, result.second);
+			},
+			error_callback);
+	}
+
+private:
+	const std::shared_ptr<const async_pool> pool;
+
+	mutable async_tasks tasks;		// needs to be destroyed before the table is closed
+
+};
+
+
+template<typename K, typename V, typename I = uint32_t>
+class async_multi_table : public multi_table<K, V, I> {
+private:
+	typedef multi_table<K, V, I> super_t;
+
+public:
+	async_multi_table(std::shared_ptr<const async_pool> pool)
+		:	pool(pool)
+	{
+		if(!pool) {
+			throw std::logic_error("async_multi_table(): pool == nullptr");
+		}
+	}
+
+	async_multi_table(std::shared_ptr<const async_pool> pool, const std::string& file_path, const ::rocksdb::Options& options = ::rocksdb::Options())
+		:	async_multi_table(pool)
+	{
+		super_t::open(file_path, options);
+	}
+
+	void async_find(const K& key,
+					const std::function<void(const std::vector<V>&)>& callback,
+					const error_callback_t& error_callback,
+					const key_mode_e mode = EQUAL) const
+	{
+		tasks.post<std::vector<V>>(
+			*pool, [this, key, mode]() {
+				std::vector<V> values;
+				super_t::find(key, values, mode);
+				return values;
+			},
+			callback, error_callback);
+	}
+
+	void async_find_last(	const K& key, const size_t limit,
+							const std::function<void(const std::vector<V>&)>& callback,
+							const error_callback_t& error_callback) const
+	{
+		tasks.post<std::vector<V>>(
+			*pool, [this, key, limit]() {
+				std::vector<V> values;
+				super_t::find_last(key, values, limit);
+				return values;
+			},
+			callback, error_callback);
+	}
+
+	void async_find_range(	const K& begin, const K& end,
+							const std::function<void(const std::vector<V>&)>& callback,
+							const error_callback_t& error_callback) const
+	{
+		tasks.post<std::vector<V>>(
+			*pool, [this, begin, end]() {
+				std::vector<V> values;
+				super_t::find_range(begin, end, values);
+				return values;
+			},
+			callback, error_callback);
+	}
+
+private:
+	const std::shared_ptr<const async_pool> pool;
+
+	mutable async_tasks tasks;		// needs to be destroyed before the table is closed
+
+};
+
+
+} // rocksdb
+} // vnx
+
+#endif /* INCLUDE_VNX_ROCKSDB_ASYNC_TABLE_H_ */
@@ -0,0 +1,277 @@
+/*
+ * change_feed.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#ifndef INCLUDE_VNX_ROCKSDB_CHANGE_FEED_H_
+#define INCLUDE_VNX_ROCKSDB_CHANGE_FEED_H_
+
+#include <vnx/rocksdb/table.h>
+
+#include <rocksdb/transaction_log.h>
+
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <fstream>
+
+
+namespace vnx {
+namespace rocksdb {
+
+/*
+ * Thrown by change_feed::poll() when the WAL since the last acknowledged sequence number
+ * is not available anymore (purged), changes have been lost. See change_feed::reset().
+ */
+class wal_gap_error : public std::runtime_error {
+public:
+	wal_gap_error(const std::string& what) : std::runtime_error(what) {}
+};
+
+/*
+ * Tails the WAL of a table and delivers decoded mutations in batches.
+ * The last acknowledged sequence number is persisted in `cursor_path`, so a restarted
+ * consumer continues where it left off. Without a cursor file the feed starts at sequence 0,
+ * or at the current end of the WAL with `start_at_latest` = true.
+ * Requires WAL retention on the table, see enable_wal_retention().
+ */
+template<typename K, typename V>
+class change_feed {
+public:
+	struct change_t {
+		uint64_t sequence = 0;
+		bool erase = false;
+		K key = K();
+		V value = V();		// default for erase
+	};
+
+	size_t max_batch_size = 1000;
+
+	change_feed(const table<K, V>& table, const std::string& cursor_path, const bool start_at_latest = false)
+		:	table_(table), cursor_path(cursor_path)
+	{
+		std::ifstream file(cursor_path);
+		if(file.good()) {
+			file >> sequence;
+		} else if(start_at_latest) {
+			reset();
+		}
+	}
+
+	/*
+	 * Returns last acknowledged sequence number.
+	 */
+	uint64_t get_sequence() const {
+		return sequence;
+	}
+
+	/*
+	 * Delivers all changes since the last acknowledged sequence number to `callback`,
+	 * in batches of up to `max_batch_size`. Unless `auto_ack` = false, changes are acknowledged
+	 * after `callback` returns, but only up to the end of the last completely delivered write,
+	 * so a large write split across batches is delivered again (in full) after a restart.
+	 * Returns number of changes delivered.
+	 * Throws wal_gap_error if the WAL since the last acknowledged sequence number has been purged.
+	 */
+	size_t poll(const std::function<void(const std::vector<change_t>&)>& callback, const bool auto_ack = true)
+	{
+		auto db = table_.db;
+		if(!db) {
+			throw std::logic_error("change_feed::poll(): table not open");
+		}
+		if(db->GetLatestSequenceNumber() <= sequence) {
+			return 0;
+		}
+		std::unique_ptr<::rocksdb::TransactionLogIterator> iter;
+		{
+			const auto status = db->GetUpdatesSince(sequence + 1, &iter);
+			if(status.IsNotFound()) {
+				throw wal_gap_error("DB::GetUpdatesSince() failed with: " + status.ToString());
+			}
+			if(!status.ok()) {
+				throw std::runtime_error("DB::GetUpdatesSince() failed with: " + status.ToString());
+			}
+		}
+		size_t total = 0;
+		uint64_t processed = sequence;		// last sequence number of the last batch processed
+		std::vector<change_t> changes;
+		Handler handler(*this, sequence, changes);
+
+		const size_t batch_size = std::max<size_t>(max_batch_size, 1);
+
+		// delivers full batches, or everything with `final` = true, acks once all processed writes are delivered
+		auto flush = [&](const bool final) {
+			size_t offset = 0;
+			while(changes.size() - offset >= batch_size || (final && offset < changes.size())) {
+				const size_t count = std::min(batch_size, changes.size() - offset);
+				if(count == changes.size()) {
+					callback(changes);
+				} else {
+					const std::vector<change_t> part(
+							std::make_move_iterator(changes.begin() + offset),
+							std::make_move_iterator(changes.begin() + offset + count));
+					callback(part);
+				}
+				offset += count;
+				total += count;
+			}
+			changes.erase(changes.begin(), changes.begin() + offset);
+
+			if(auto_ack && changes.empty() && processed > sequence) {
+				ack(processed);
+			}
+		};
+		for(; iter->Valid(); iter->Next())
+		{
+			auto batch = iter->GetBatch();
+			if(batch.sequence > processed + 1) {
+				throw wal_gap_error("change_feed::poll(): WAL gap from " + std::to_string(processed + 1)
+						+ " to " + std::to_string(batch.sequence));
+			}
+			handler.sequence = batch.sequence;
+			const auto status = batch.writeBatchPtr->Iterate(&handler);
+			if(!status.ok()) {
+				throw std::runtime_error("WriteBatch::Iterate() failed with: " + status.ToString());
+			}
+			if(handler.sequence > processed + 1) {
+				processed = handler.sequence - 1;
+			}
+			if(changes.size() >= batch_size) {
+				flush(false);
+			}
+		}
+		{
+			const auto status = iter->status();
+			if(!status.ok()) {
+				throw std::runtime_error("TransactionLogIterator failed with: " + status.ToString());
+			}
+		}
+		flush(true);
+		return total;
+	}
+
+	/*
+	 * Skips all changes so far, continues at the current end of the WAL.
+	 * Used to recover from a wal_gap_error (after re-syncing the consumer by other means).
+	 */
+	void reset()
+	{
+		auto db = table_.db;
+		if(!db) {
+			throw std::logic_error("change_feed::reset(): table not open");
+		}
+		ack(db->GetLatestSequenceNumber());
+	}
+
+	/*
+	 * Marks all changes up to `sequence_` as processed.
+	 */
+	void ack(const uint64_t sequence_)
+	{
+		sequence = sequence_;
+
+		const auto tmp_path = cursor_path + ".tmp";
+		{
+			std::ofstream file(tmp_path, std::ios::trunc);
+			file << sequence << std::endl;
+			if(!file.good()) {
+				throw std::runtime_error("change_feed::ack(): failed to write " + tmp_path);
+			}
+		}
+		if(std::rename(tmp_path.c_str(), cursor_path.c_str())) {
+			throw std::runtime_error("change_feed::ack(): failed to rename " + tmp_path);
+		}
+	}
+
+private:
+	class Handler : public ::rocksdb::WriteBatch::Handler {
+	public:
+		uint64_t sequence = 0;
+
+		Handler(const change_feed& feed, const uint64_t since, std::vector<change_t>& changes)
+			:	feed(feed), since(since), changes(changes) {}
+
+		::rocksdb::Status PutCF(uint32_t column_family_id, const ::rocksdb::Slice& key, const ::rocksdb::Slice& value) override
+		{
+			const auto seq = sequence++;
+			if(seq > since) {
+				change_t change;
+				change.sequence = seq;
+				try {
+					feed.read_key(key, change.key);
+					feed.read_value(value, change.value);
+					changes.push_back(std::move(change));
+				} catch(...) {
+					// ignore
+				}
+			}
+			return ::rocksdb::Status::OK();
+		}
+
+		::rocksdb::Status DeleteCF(uint32_t column_family_id, const ::rocksdb::Slice& key) override
+		{
+			const auto seq = sequence++;
+			if(seq > since) {
+				change_t change;
+				change.sequence = seq;
+				change.erase = true;
+				try {
+					feed.read_key(key, change.key);
+					changes.push_back(std::move(change));
+				} catch(...) {
+					// ignore
+				}
+			}
+			return ::rocksdb::Status::OK();
+		}
+
+		::rocksdb::Status SingleDeleteCF(uint32_t column_family_id, const ::rocksdb::Slice& key) override
+		{
+			return DeleteCF(column_family_id, key);
+		}
+
+		::rocksdb::Status DeleteRangeCF(uint32_t column_family_id, const ::rocksdb::Slice& begin, const ::rocksdb::Slice& end) override
+		{
+			sequence++;		// not supported
+			return ::rocksdb::Status::OK();
+		}
+
+		::rocksdb::Status MergeCF(uint32_t column_family_id, const ::rocksdb::Slice& key, const ::rocksdb::Slice& value) override
+		{
+			sequence++;		// not supported
+			return ::rocksdb::Status::OK();
+		}
+
+	private:
+		const change_feed& feed;
+		const uint64_t since;
+		std::vector<change_t>& changes;
+	};
+
+	void read_key(const ::rocksdb::Slice& slice, K& key) const
+	{
+		table<K, V>::read(slice, key, table_.key_type, table_.key_code);
+	}
+
+	void read_value(const ::rocksdb::Slice& slice, V& value) const
+	{
+		table<K, V>::read(slice, value, table_.value_type, table_.value_code);
+	}
+
+private:
+	const table<K, V>& table_;
+	const std::string cursor_path;
+
+	uint64_t sequence = 0;
+
+};
+
+
+} // rocksdb
+} // vnx
+
+#endif /* INCLUDE_VNX_ROCKSDB_CHANGE_FEED_H_ */
@@ -10,26 +10,73 @@
 
 #include <vnx/rocksdb/table.h>
 
+#include <rocksdb/table.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
+
 #include <mutex>
+#include <cstring>
 
 
 namespace vnx {
 namespace rocksdb {
 
+/*
+ * All methods are thread-safe, insert() / insert_many() are serialized to allocate indices.
+ * Range erases are not atomic with respect to concurrent inserts on the same keys.
+ */
 template<typename K, typename V, typename I = uint32_t>
 class multi_table : table<std::pair<K, I>, V> {
 private:
 	typedef table<std::pair<K, I>, V> super_t;
 
+	/*
+	 * Maps encoded [K, I] to encoded K, by cutting off the fixed size index.
+	 */
+	class PrefixExtractor : public ::rocksdb::SliceTransform {
+	public:
+		const char* Name() const override {
+			return "vnx.rocksdb.multi_table.PrefixExtractor";
+		}
+
+		::rocksdb::Slice Transform(const ::rocksdb::Slice& key) const override {
+			return ::rocksdb::Slice(key.data(), key.size() - sizeof(I));
+		}
+
+		bool InDomain(const ::rocksdb::Slice& key) const override {
+			return key.size() >= sizeof(I);
+		}
+	};
+
 public:
+	using super_t::monitor;
+
 	multi_table() = default;
 
 	multi_table(const std::string& file_path, const ::rocksdb::Options& options = ::rocksdb::Options())
-		:	super_t(file_path, options)
 	{
+		open(file_path, options);
 	}
 
-	void open(const std::string& file_path, const ::rocksdb::Options& options = ::rocksdb::Options()) {
+	void open(const std::string& file_path, ::rocksdb::Options options = ::rocksdb::Options())
+	{
+		if(super_t::is_plain_table(options)) {
+			throw std::logic_error("multi_table::open(): PlainTable is not supported");
+		}
+		if(has_fixed_index())
+		{
+			options.prefix_extractor = std::make_shared<PrefixExtractor>();
+			options.memtable_prefix_bloom_size_ratio = 0.1;
+
+			if(auto factory = options.table_factory->GetOptions<::rocksdb::BlockBasedTableOptions>()) {
+				auto table_options = *factory;
+				if(!table_options.filter_policy) {
+					table_options.filter_policy.reset(::rocksdb::NewBloomFilterPolicy(10));
+					table_options.whole_key_filtering = false;
+				}
+				options.table_factory.reset(::rocksdb::NewBlockBasedTableFactory(table_options));
+			}
+		}
 		super_t::open(file_path, options);
 	}
 
@@ -46,11 +93,19 @@ public:
 	{
 		std::pair<K, I> key_(key, std::numeric_limits<I>::max());
 
-		::rocksdb::ReadOptions options;
-		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
+		typename super_t::stream_t bound_stream;
+		const auto lower_bound = super_t::write(bound_stream, std::pair<K, I>(key, 0), super_t::key_type, super_t::key_code);
 
+		// throttle before locking, to not block inserts of other keys
+		if(monitor) {
+			monitor->throttle();
+		}
 		std::lock_guard<std::mutex> lock(mutex);
 
+		// iterator needs to be created after locking, otherwise it might not see the last insert
+		const auto options = get_iter_options(EQUAL, &lower_bound);
+		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
+
 		typename super_t::stream_t key_stream;
 		iter->SeekForPrev(super_t::write(key_stream, key_, super_t::key_type, super_t::key_code));
 		key_.second = 0;
@@ -61,14 +116,26 @@ public:
 			if(found.first == key) {
 				key_.second = found.second + 1;
 			}
+		} else {
+			super_t::check_status(iter.get());		// would overwrite existing values otherwise
 		}
+		typename super_t::stream_t entry_key_stream(super_t::disable_type_codes);
+		typename super_t::stream_t value_stream(super_t::disable_type_codes);
+
+		::rocksdb::WriteBatch batch;
 		for(const auto& value : values) {
 			if(key_.second == std::numeric_limits<I>::max()) {
 				throw std::runtime_error("key space overflow");
 			}
-			super_t::insert(key_, value);
+			batch.Put(	super_t::write(entry_key_stream, key_, super_t::key_type, super_t::key_code),
+						super_t::write(value_stream, value, super_t::value_type, super_t::value_code));
 			key_.second++;
 		}
+		::rocksdb::WriteOptions write_options;
+		const auto status = super_t::db->Write(write_options, &batch);
+		if(!status.ok()) {
+			throw std::runtime_error("DB::Write() failed with: " + status.ToString());
+		}
 	}
 
 	size_t find(const K& key, std::vector<V>& values, const key_mode_e mode = EQUAL) const
@@ -76,7 +143,10 @@ public:
 		values.clear();
 		std::pair<K, I> key_(key, 0);
 
-		::rocksdb::ReadOptions options;
+		typename super_t::stream_t bound_stream;
+		const auto upper_bound = super_t::write(bound_stream, std::pair<K, I>(key, std::numeric_limits<I>::max()), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(mode, nullptr, mode == EQUAL ? &upper_bound : nullptr);
 		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
 
 		typename super_t::stream_t key_stream;
@@ -103,7 +173,10 @@ public:
 		values.clear();
 		std::pair<K, I> key_(key, std::numeric_limits<I>::max());
 
-		::rocksdb::ReadOptions options;
+		typename super_t::stream_t bound_stream;
+		const auto lower_bound = super_t::write(bound_stream, std::pair<K, I>(key, 0), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(EQUAL, &lower_bound);
 		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
 
 		typename super_t::stream_t key_stream;
@@ -124,6 +197,7 @@ public:
 			}
 			iter->Prev();
 		}
+		super_t::check_status(iter.get());
 		return values.size();
 	}
 
@@ -132,7 +206,10 @@ public:
 		values.clear();
 		std::pair<K, I> key_(begin, 0);
 
-		::rocksdb::ReadOptions options;
+		typename super_t::stream_t bound_stream;
+		const auto upper_bound = super_t::write(bound_stream, std::pair<K, I>(end, 0), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(GREATER_EQUAL, nullptr, &upper_bound);
 		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
 
 		typename super_t::stream_t key_stream;
@@ -159,7 +236,10 @@ public:
 		result.clear();
 		std::pair<K, I> key_(begin, 0);
 
-		::rocksdb::ReadOptions options;
+		typename super_t::stream_t bound_stream;
+		const auto upper_bound = super_t::write(bound_stream, std::pair<K, I>(end, 0), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(GREATER_EQUAL, nullptr, &upper_bound);
 		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
 
 		typename super_t::stream_t key_stream;
@@ -194,11 +274,17 @@ public:
 		return super_t::erase(std::pair<K, I>(key, index));
 	}
 
-	size_t erase_match(const K& key, const V& value) const
+	size_t erase_match(const K& key, const V& value)
 	{
+		if(monitor) {
+			monitor->throttle();
+		}
 		std::pair<K, I> key_(key, 0);
 
-		::rocksdb::ReadOptions options;
+		typename super_t::stream_t bound_stream;
+		const auto upper_bound = super_t::write(bound_stream, std::pair<K, I>(key, std::numeric_limits<I>::max()), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(EQUAL, nullptr, &upper_bound);
 		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
 
 		size_t count = 0;
@@ -227,7 +313,13 @@ public:
 
 	size_t erase_all(const K& key, const key_mode_e mode = EQUAL)
 	{
-		::rocksdb::ReadOptions options;
+		if(monitor) {
+			monitor->throttle();
+		}
+		typename super_t::stream_t bound_stream;
+		const auto upper_bound = super_t::write(bound_stream, std::pair<K, I>(key, std::numeric_limits<I>::max()), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(mode, nullptr, mode == EQUAL ? &upper_bound : nullptr);
 		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
 
 		size_t count = 0;
@@ -251,9 +343,15 @@ public:
 		return count;
 	}
 
-	size_t erase_range(const K& begin, const K& end) const
+	size_t erase_range(const K& begin, const K& end)
 	{
-		::rocksdb::ReadOptions options;
+		if(monitor) {
+			monitor->throttle();
+		}
+		typename super_t::stream_t bound_stream;
+		const auto upper_bound = super_t::write(bound_stream, std::pair<K, I>(end, 0), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(GREATER_EQUAL, nullptr, &upper_bound);
 		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
 
 		size_t count = 0;
@@ -289,6 +387,89 @@ public:
 		super_t::flush();
 	}
 
+	void checkpoint(const std::string& path) const {
+		super_t::checkpoint(path);
+	}
+
+	uint32_t backup(const std::string& backup_dir, const uint32_t max_backups = 0) const {
+		return super_t::backup(backup_dir, max_backups);
+	}
+
+	storage_stats_t get_storage_stats() const {
+		return super_t::get_storage_stats();
+	}
+
+	uint64_t approx_count() const {
+		return super_t::approx_count();
+	}
+
+	uint64_t approx_size() const {
+		return super_t::approx_size();
+	}
+
+	/*
+	 * Estimated number of values for `key`.
+	 */
+	uint64_t approx_count(const K& key) const {
+		return super_t::approx_range_count(std::pair<K, I>(key, 0), std::pair<K, I>(key, std::numeric_limits<I>::max()));
+	}
+
+	/*
+	 * Estimated size in bytes of all values for keys within [begin, end).
+	 */
+	uint64_t approx_range_size(const K& begin, const K& end) const {
+		return super_t::approx_range_size(std::pair<K, I>(begin, 0), std::pair<K, I>(end, 0));
+	}
+
+	/*
+	 * Exact number of values for `key`, without decoding them.
+	 */
+	uint64_t count(const K& key) const {
+		return super_t::count_range(std::pair<K, I>(key, 0), std::pair<K, I>(key, std::numeric_limits<I>::max()));
+	}
+
+	/*
+	 * Exact number of values for keys within [begin, end), without decoding them.
+	 */
+	uint64_t count_range(const K& begin, const K& end) const {
+		return super_t::count_range(std::pair<K, I>(begin, 0), std::pair<K, I>(end, 0));
+	}
+
+private:
+	/*
+	 * Bounds need to stay valid for the lifetime of the iterator.
+	 */
+	static ::rocksdb::ReadOptions get_iter_options(
+			const key_mode_e mode, const ::rocksdb::Slice* lower_bound = nullptr, const ::rocksdb::Slice* upper_bound = nullptr)
+	{
+		::rocksdb::ReadOptions options;
+		if(mode == EQUAL) {
+			options.prefix_same_as_start = true;
+		} else {
+			options.total_order_seek = true;
+			options.adaptive_readahead = true;
+			options.async_io = true;
+		}
+		options.iterate_lower_bound = lower_bound;
+		options.iterate_upper_bound = upper_bound;
+		return options;
+	}
+
+	/*
+	 * Checks that [K, I] is encoded as K followed by a fixed size I,
+	 * which is required for the prefix extractor.
+	 */
+	bool has_fixed_index() const
+	{
+		typename super_t::stream_t stream_a;
+		typename super_t::stream_t stream_b;
+		const auto a = super_t::write(stream_a, std::pair<K, I>(K(), 0), super_t::key_type, super_t::key_code);
+		const auto b = super_t::write(stream_b, std::pair<K, I>(K(), std::numeric_limits<I>::max()), super_t::key_type, super_t::key_code);
+		return a.size() == b.size() && a.size() > sizeof(I)
+				&& ::memcmp(a.data(), b.data(), a.size() - sizeof(I)) == 0
+				&& ::memcmp(a.data() + a.size() - sizeof(I), b.data() + b.size() - sizeof(I), sizeof(I)) != 0;
+	}
+
 private:
 	std::mutex mutex;
 
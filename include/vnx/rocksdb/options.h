@@ -0,0 +1,78 @@
+/*
+ * options.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#ifndef INCLUDE_VNX_ROCKSDB_OPTIONS_H_
+#define INCLUDE_VNX_ROCKSDB_OPTIONS_H_
+
+#include <rocksdb/cache.h>
+#include <rocksdb/options.h>
+
+#include <memory>
+#include <string>
+
+
+namespace vnx {
+namespace rocksdb {
+
+enum profile_e {
+	DEFAULT_PROFILE,
+	POINT_LOOKUP,		// random find(), mostly misses: ribbon filter, data block hash index (integral keys only), cached index / filter blocks
+	APPEND_LOG,			// append mostly multi_table logs: universal compaction, large memtables
+	SCAN_HEAVY,			// range queries / full scans: large blocks, compaction readahead
+	SMALL_METADATA,		// small tables: small memtables, bloom filter, few log files
+	LARGE_VALUE,		// large values (blocks, proofs): values stored in blob files, see enable_blob_files()
+	READ_MOSTLY			// small, rarely written tables: mmap'ed PlainTable files, see enable_plain_table() for limitations
+};
+
+/*
+ * Returns `options` tuned for the given workload profile, table options already set in `options` are kept.
+ * `block_cache` should be shared by all tables (RocksDB creates a small cache per table otherwise).
+ */
+::rocksdb::Options get_options(	const profile_e profile, ::rocksdb::Options options = ::rocksdb::Options(),
+								std::shared_ptr<::rocksdb::Cache> block_cache = nullptr);
+
+std::string get_profile_name(const profile_e profile);
+
+/*
+ * Enables integrated BlobDB: values >= `min_blob_size` are stored in separate blob files,
+ * so compaction only rewrites small references. Blob files with more than `gc_age_cutoff`
+ * of their age (relative to all blob files) get garbage collected during compaction.
+ */
+::rocksdb::Options enable_blob_files(	::rocksdb::Options options, const uint64_t min_blob_size = 4096,
+										const ::rocksdb::CompressionType compression = ::rocksdb::kNoCompression,
+										const double gc_age_cutoff = 0.25);
+
+/*
+ * Enables ZSTD compression with a dictionary of up to `max_dict_bytes`, trained on
+ * `max_dict_bytes` * `train_factor` bytes sampled from the data of each SST file during compaction.
+ * Helps with small and repetitive values, such as vnx serialized structs without type codes.
+ */
+::rocksdb::Options enable_dict_compression(	::rocksdb::Options options, const uint32_t max_dict_bytes = 16 * 1024,
+											const uint32_t train_factor = 100);
+
+/*
+ * Switches to mmap'ed PlainTable files, point lookups then read directly from the mapping,
+ * without block decoding and block cache. Only suitable for tables which fit in RAM.
+ * `key_size` = 0 means variable length keys.
+ * With `hash_index` = true an in-memory hash index over the full key is used, in which case
+ * only point lookups are supported (no scans or range queries).
+ * PlainTable has no backward iteration (SeekForPrev(), SeekToLast(), Prev()), so only
+ * table::find(), find_many() and scan() are supported: table::find_last() throws,
+ * multi_table and packed_multi_table refuse to open.
+ */
+::rocksdb::Options enable_plain_table(::rocksdb::Options options, const uint32_t key_size = 0, const bool hash_index = false);
+
+/*
+ * Keeps WAL files for `ttl_sec` after they were flushed, as needed by change_feed.
+ */
+::rocksdb::Options enable_wal_retention(::rocksdb::Options options, const uint64_t ttl_sec = 24 * 3600);
+
+
+} // rocksdb
+} // vnx
+
+#endif /* INCLUDE_VNX_ROCKSDB_OPTIONS_H_ */
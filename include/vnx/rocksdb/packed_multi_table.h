@@ -0,0 +1,512 @@
+/*
+ * packed_multi_table.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#ifndef INCLUDE_VNX_ROCKSDB_PACKED_MULTI_TABLE_H_
+#define INCLUDE_VNX_ROCKSDB_PACKED_MULTI_TABLE_H_
+
+#include <vnx/rocksdb/table.h>
+
+#include <rocksdb/merge_operator.h>
+#include <rocksdb/write_batch.h>
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <cstring>
+#include <algorithm>
+
+
+namespace vnx {
+namespace rocksdb {
+
+/*
+ * Alternative multi_table layout for keys with large fan-out.
+ * Values of a key are packed into rows [key, chunk], each row holding a list of
+ * length-prefixed serialized values. New values are appended to the head row [key, HEAD]
+ * via a merge operator (no read before write). repack() moves the head into sealed chunks.
+ * Reading all values of a key only visits a few rows.
+ *
+ * With `auto_repack` a key is repacked once `chunk_size` values have been appended to it
+ * by this instance. Append counts are only kept in memory for up to `max_pending_keys` keys,
+ * beyond that the coldest half is dropped, so keys with rare appends need an explicit repack()
+ * to bound their head row.
+ */
+template<typename K, typename V>
+class packed_multi_table : table<std::pair<K, uint32_t>, V> {
+private:
+	typedef table<std::pair<K, uint32_t>, V> super_t;
+
+	static constexpr uint32_t HEAD = std::numeric_limits<uint32_t>::max();
+
+	/*
+	 * Concatenates all operands in a single pass.
+	 */
+	class AppendOperator : public ::rocksdb::MergeOperator {
+	public:
+		bool FullMergeV2(const MergeOperationInput& merge_in, MergeOperationOutput* merge_out) const override
+		{
+			size_t size = merge_in.existing_value ? merge_in.existing_value->size() : 0;
+			for(const auto& operand : merge_in.operand_list) {
+				size += operand.size();
+			}
+			auto& out = merge_out->new_value;
+			out.clear();
+			out.reserve(size);
+			if(merge_in.existing_value) {
+				out.append(merge_in.existing_value->data(), merge_in.existing_value->size());
+			}
+			for(const auto& operand : merge_in.operand_list) {
+				out.append(operand.data(), operand.size());
+			}
+			return true;
+		}
+
+		bool PartialMergeMulti(	const ::rocksdb::Slice& key, const std::deque<::rocksdb::Slice>& operand_list,
+								std::string* new_value, ::rocksdb::Logger* logger) const override
+		{
+			size_t size = 0;
+			for(const auto& operand : operand_list) {
+				size += operand.size();
+			}
+			new_value->clear();
+			new_value->reserve(size);
+			for(const auto& operand : operand_list) {
+				new_value->append(operand.data(), operand.size());
+			}
+			return true;
+		}
+
+		const char* Name() const override {
+			return "vnx.rocksdb.packed_multi_table.AppendOperator";
+		}
+	};
+
+public:
+	using super_t::monitor;
+
+	size_t chunk_size = 1024;			// max number of values per sealed chunk
+	bool auto_repack = true;			// repack a key after `chunk_size` appends
+	size_t max_pending_keys = 65536;	// max number of keys to count appends for
+
+	packed_multi_table() = default;
+
+	packed_multi_table(const std::string& file_path, const ::rocksdb::Options& options = ::rocksdb::Options())
+	{
+		open(file_path, options);
+	}
+
+	void open(const std::string& file_path, ::rocksdb::Options options = ::rocksdb::Options())
+	{
+		if(super_t::is_plain_table(options)) {
+			throw std::logic_error("packed_multi_table::open(): PlainTable is not supported");
+		}
+		options.merge_operator = std::make_shared<AppendOperator>();
+		super_t::open(file_path, options);
+	}
+
+	void close() {
+		super_t::close();
+	}
+
+	void insert(const K& key, const V& value)
+	{
+		insert_many(key, {value});
+	}
+
+	void insert_many(const K& key, const std::vector<V>& values)
+	{
+		if(values.empty()) {
+			return;
+		}
+		std::string data;
+		typename super_t::stream_t value_stream(super_t::disable_type_codes);
+		for(const auto& value : values) {
+			append(data, super_t::write(value_stream, value, super_t::value_type, super_t::value_code));
+		}
+		typename super_t::stream_t key_stream(super_t::disable_type_codes);
+
+		if(monitor) {
+			monitor->throttle();
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+
+		::rocksdb::WriteOptions options;
+		const auto status = super_t::db->Merge(options,
+				super_t::write(key_stream, std::pair<K, uint32_t>(key, HEAD), super_t::key_type, super_t::key_code), data);
+
+		if(!status.ok()) {
+			throw std::runtime_error("DB::Merge() failed with: " + status.ToString());
+		}
+		if(auto_repack) {
+			auto& count = pending[key];
+			count += values.size();
+			if(count >= chunk_size) {
+				pending.erase(key);
+				repack_locked(key);
+			} else if(pending.size() > max_pending_keys) {
+				evict_pending();
+			}
+		}
+	}
+
+	size_t find(const K& key, std::vector<V>& values) const
+	{
+		values.clear();
+		scan_chunks(key, [this, &values](const ::rocksdb::Slice& chunk_key, const ::rocksdb::Slice& chunk) {
+			unpack(chunk, values);
+		});
+		std::string head;
+		if(get_head(key, head)) {
+			unpack(head, values);
+		}
+		return values.size();
+	}
+
+	/*
+	 * Returns up to `limit` most recent values, newest first.
+	 */
+	size_t find_last(const K& key, std::vector<V>& values, const size_t limit) const
+	{
+		values.clear();
+		std::pair<K, uint32_t> key_(key, HEAD);
+
+		typename super_t::stream_t bound_stream;
+		const auto lower_bound = super_t::write(bound_stream, std::pair<K, uint32_t>(key, 0), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(&lower_bound, nullptr);
+		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
+
+		typename super_t::stream_t key_stream;
+		iter->SeekForPrev(super_t::write(key_stream, key_, super_t::key_type, super_t::key_code));
+
+		std::vector<V> chunk;
+		while(iter->Valid() && values.size() < limit)
+		{
+			super_t::read(iter->key(), key_, super_t::key_type, super_t::key_code);
+			if(!(key_.first == key)) {
+				break;
+			}
+			chunk.clear();
+			unpack(iter->value(), chunk);
+			for(auto it = chunk.rbegin(); it != chunk.rend() && values.size() < limit; ++it) {
+				values.push_back(std::move(*it));
+			}
+			iter->Prev();
+		}
+		super_t::check_status(iter.get());
+		return values.size();
+	}
+
+	/*
+	 * Returns the number of values for `key`, without decoding them.
+	 */
+	size_t count(const K& key) const
+	{
+		size_t count = 0;
+		scan_chunks(key, [&count](const ::rocksdb::Slice& chunk_key, const ::rocksdb::Slice& chunk) {
+			count += parse(chunk, [](const ::rocksdb::Slice&) {});
+		});
+		std::string head;
+		if(get_head(key, head)) {
+			count += parse(head, [](const ::rocksdb::Slice&) {});
+		}
+		return count;
+	}
+
+	void scan(const std::function<void(const K&, const V&)>& callback) const
+	{
+		::rocksdb::ReadOptions options;
+		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
+
+		std::vector<V> values;
+		iter->SeekToFirst();
+		while(iter->Valid()) {
+			std::pair<K, uint32_t> key;
+			bool valid = false;
+			try {
+				super_t::read(iter->key(), key, super_t::key_type, super_t::key_code);
+				valid = true;
+			} catch(...) {
+				// ignore
+			}
+			if(valid) {
+				values.clear();
+				unpack(iter->value(), values);
+				for(const auto& value : values) {
+					callback(key.first, value);
+				}
+			}
+			iter->Next();
+		}
+	}
+
+	/*
+	 * Moves the values in the head row of `key` into sealed chunks of `chunk_size`.
+	 * Returns the number of chunks written.
+	 */
+	size_t repack(const K& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.erase(key);
+		return repack_locked(key);
+	}
+
+	size_t erase_all(const K& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.erase(key);
+
+		::rocksdb::WriteBatch batch;
+		size_t count = 0;
+		scan_chunks(key, [&count, &batch](const ::rocksdb::Slice& chunk_key, const ::rocksdb::Slice& chunk) {
+			count += parse(chunk, [](const ::rocksdb::Slice&) {});
+			batch.Delete(chunk_key);
+		});
+		std::string head;
+		if(get_head(key, head)) {
+			count += parse(head, [](const ::rocksdb::Slice&) {});
+			typename super_t::stream_t key_stream;
+			batch.Delete(super_t::write(key_stream, std::pair<K, uint32_t>(key, HEAD), super_t::key_type, super_t::key_code));
+		}
+		::rocksdb::WriteOptions write_options;
+		const auto status = super_t::db->Write(write_options, &batch);
+		if(!status.ok()) {
+			throw std::runtime_error("DB::Write() failed with: " + status.ToString());
+		}
+		return count;
+	}
+
+	size_t truncate()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.clear();
+		return super_t::truncate();
+	}
+
+	void compact() {
+		super_t::compact();
+	}
+
+	void flush() {
+		super_t::flush();
+	}
+
+	void checkpoint(const std::string& path) const {
+		super_t::checkpoint(path);
+	}
+
+	uint32_t backup(const std::string& backup_dir, const uint32_t max_backups = 0) const {
+		return super_t::backup(backup_dir, max_backups);
+	}
+
+	storage_stats_t get_storage_stats() const {
+		return super_t::get_storage_stats();
+	}
+
+private:
+	static ::rocksdb::ReadOptions get_iter_options(const ::rocksdb::Slice* lower_bound, const ::rocksdb::Slice* upper_bound)
+	{
+		::rocksdb::ReadOptions options;
+		options.total_order_seek = true;
+		options.iterate_lower_bound = lower_bound;
+		options.iterate_upper_bound = upper_bound;
+		return options;
+	}
+
+	/*
+	 * Calls `callback` for all sealed chunks of `key`, in order.
+	 * Iterates within [key, 0] .. [key, HEAD), so tombstones of other keys are not visited.
+	 */
+	template<typename F>
+	void scan_chunks(const K& key, const F& callback) const
+	{
+		std::pair<K, uint32_t> key_(key, 0);
+
+		typename super_t::stream_t bound_stream;
+		const auto upper_bound = super_t::write(bound_stream, std::pair<K, uint32_t>(key, HEAD), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(nullptr, &upper_bound);
+		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
+
+		typename super_t::stream_t key_stream;
+		iter->Seek(super_t::write(key_stream, key_, super_t::key_type, super_t::key_code));
+		while(iter->Valid()) {
+			super_t::read(iter->key(), key_, super_t::key_type, super_t::key_code);
+			if(!(key_.first == key)) {
+				break;
+			}
+			callback(iter->key(), iter->value());
+			iter->Next();
+		}
+		super_t::check_status(iter.get());
+	}
+
+	/*
+	 * Reads the head row [key, HEAD] (which is excluded by the upper bound in scan_chunks()).
+	 */
+	bool get_head(const K& key, std::string& value) const
+	{
+		typename super_t::stream_t key_stream;
+		::rocksdb::ReadOptions options;
+		const auto status = super_t::db->Get(options,
+				super_t::write(key_stream, std::pair<K, uint32_t>(key, HEAD), super_t::key_type, super_t::key_code), &value);
+		if(status.IsNotFound()) {
+			return false;
+		}
+		if(!status.ok()) {
+			throw std::runtime_error("DB::Get() failed with: " + status.ToString());
+		}
+		return true;
+	}
+
+	/*
+	 * Drops the counters of the coldest (smallest count) half of `pending`, hot keys keep theirs.
+	 */
+	void evict_pending()
+	{
+		std::vector<size_t> counts;
+		counts.reserve(pending.size());
+		for(const auto& entry : pending) {
+			counts.push_back(entry.second);
+		}
+		const auto median = counts.begin() + counts.size() / 2;
+		std::nth_element(counts.begin(), median, counts.end());
+		const auto limit = *median;
+
+		const size_t target = pending.size() - counts.size() / 2;
+		for(auto iter = pending.begin(); iter != pending.end();) {
+			if(iter->second < limit) {
+				iter = pending.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+		for(auto iter = pending.begin(); iter != pending.end() && pending.size() > target;) {
+			if(iter->second == limit) {
+				iter = pending.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+	}
+
+	size_t repack_locked(const K& key)
+	{
+		std::pair<K, uint32_t> key_(key, HEAD);
+
+		typename super_t::stream_t bound_stream;
+		const auto lower_bound = super_t::write(bound_stream, std::pair<K, uint32_t>(key, 0), super_t::key_type, super_t::key_code);
+
+		const auto options = get_iter_options(&lower_bound, nullptr);
+		std::unique_ptr<::rocksdb::Iterator> iter(super_t::db->NewIterator(options));
+
+		typename super_t::stream_t key_stream;
+		iter->SeekForPrev(super_t::write(key_stream, key_, super_t::key_type, super_t::key_code));
+		if(!iter->Valid()) {
+			super_t::check_status(iter.get());
+			return 0;
+		}
+		super_t::read(iter->key(), key_, super_t::key_type, super_t::key_code);
+		if(!(key_.first == key) || key_.second != HEAD) {
+			return 0;
+		}
+		const std::string head = iter->value().ToString();
+
+		uint32_t next = 0;
+		iter->Prev();
+		if(iter->Valid()) {
+			std::pair<K, uint32_t> prev;
+			super_t::read(iter->key(), prev, super_t::key_type, super_t::key_code);
+			if(prev.first == key) {
+				next = prev.second + 1;
+			}
+		} else {
+			super_t::check_status(iter.get());		// would overwrite existing chunks otherwise
+		}
+		::rocksdb::WriteBatch batch;
+		std::string chunk;
+		size_t num_values = 0;
+		size_t num_chunks = 0;
+		parse(head, [&](const ::rocksdb::Slice& record) {
+			append(chunk, record);
+			if(++num_values >= chunk_size) {
+				if(next == HEAD) {
+					throw std::runtime_error("key space overflow");
+				}
+				batch.Put(super_t::write(key_stream, std::pair<K, uint32_t>(key, next++), super_t::key_type, super_t::key_code), chunk);
+				chunk.clear();
+				num_values = 0;
+				num_chunks++;
+			}
+		});
+		if(!num_chunks) {
+			return 0;
+		}
+		const auto head_key = super_t::write(key_stream, std::pair<K, uint32_t>(key, HEAD), super_t::key_type, super_t::key_code);
+		if(chunk.empty()) {
+			batch.Delete(head_key);
+		} else {
+			batch.Put(head_key, chunk);
+		}
+		::rocksdb::WriteOptions write_options;
+		const auto status = super_t::db->Write(write_options, &batch);
+		if(!status.ok()) {
+			throw std::runtime_error("DB::Write() failed with: " + status.ToString());
+		}
+		return num_chunks;
+	}
+
+	static void append(std::string& data, const ::rocksdb::Slice& record)
+	{
+		const uint32_t size = record.size();
+		data.append((const char*)&size, sizeof(size));
+		data.append(record.data(), record.size());
+	}
+
+	template<typename F>
+	static size_t parse(const ::rocksdb::Slice& data, const F& callback)
+	{
+		size_t count = 0;
+		size_t offset = 0;
+		while(offset + sizeof(uint32_t) <= data.size()) {
+			uint32_t size = 0;
+			::memcpy(&size, data.data() + offset, sizeof(size));
+			offset += sizeof(size);
+			if(offset + size > data.size()) {
+				break;
+			}
+			callback(::rocksdb::Slice(data.data() + offset, size));
+			offset += size;
+			count++;
+		}
+		return count;
+	}
+
+	void unpack(const ::rocksdb::Slice& data, std::vector<V>& values) const
+	{
+		parse(data, [this, &values](const ::rocksdb::Slice& record) {
+			try {
+				V tmp = V();
+				super_t::read(record, tmp, super_t::value_type, super_t::value_code);
+				values.push_back(std::move(tmp));
+			} catch(...) {
+				// ignore
+			}
+		});
+	}
+
+private:
+	std::mutex mutex;
+	std::map<K, size_t> pending;		// number of appends since last repack
+
+};
+
+
+} // rocksdb
+} // vnx
+
+#endif /* INCLUDE_VNX_ROCKSDB_PACKED_MULTI_TABLE_H_ */
@@ -12,6 +12,9 @@
 #include <rocksdb/slice.h>
 #include <rocksdb/options.h>
 
+#include <vnx/rocksdb/util.h>
+#include <vnx/rocksdb/write_monitor.h>
+
 #include <limits>
 #include <atomic>
 
@@ -24,6 +27,8 @@ typedef std::pair<const void*, size_t> raw_data_t;
 
 class raw_table {
 public:
+	std::shared_ptr<write_monitor> monitor;		// optional, needs to be set before open()
+
 	raw_table() {}
 
 	raw_table(const std::string& file_path, const ::rocksdb::Options& options = ::rocksdb::Options())
@@ -40,21 +45,33 @@ public:
 	{
 		close();
 		options.create_if_missing = true;
+		if(monitor) {
+			options.listeners.push_back(monitor);
+		}
 
 		const auto status = ::rocksdb::DB::Open(options, file_path, &db);
 		if(!status.ok()) {
 			throw std::runtime_error("DB::Open() failed with: " + status.ToString());
 		}
+		if(monitor) {
+			monitor->attach(db);
+		}
 	}
 
 	void close()
 	{
+		if(monitor) {
+			monitor->attach(nullptr);
+		}
 		delete db;
 		db = nullptr;
 	}
 
 	void insert(const raw_data_t& key, const raw_data_t& value)
 	{
+		if(monitor) {
+			monitor->throttle();
+		}
 		::rocksdb::WriteOptions options;
 		const auto status = db->Put(options, to_slice(key), to_slice(value));
 
@@ -107,6 +124,9 @@ public:
 
 	bool erase(const raw_data_t& key)
 	{
+		if(monitor) {
+			monitor->throttle();
+		}
 		::rocksdb::WriteOptions options;
 		const auto status = db->Delete(options, to_slice(key));
 
@@ -119,23 +139,20 @@ public:
 		return true;
 	}
 
-	size_t erase_many(const std::vector<raw_data_t>& keys)
+	/*
+	 * Returns number of keys erased, see erase_keys().
+	 */
+	size_t erase_many(const std::vector<raw_data_t>& keys, const bool single_delete = false)
 	{
-		std::atomic<size_t> count {0};
-		if(keys.size() > size_t(std::numeric_limits<int>::max())) {
-			throw std::logic_error("keys.size() > INT_MAX");
+		std::vector<::rocksdb::Slice> slices;
+		slices.reserve(keys.size());
+		for(const auto& key : keys) {
+			slices.push_back(to_slice(key));
 		}
-#pragma omp parallel for
-		for(int i = 0; i < int(keys.size()); ++i) {
-			try {
-				if(erase(keys[i])) {
-					count++;
-				}
-			} catch(...) {
-				// ignore
-			}
+		if(monitor) {
+			monitor->throttle();
 		}
-		return count;
+		return erase_keys(db, std::move(slices), single_delete);
 	}
 
 	void compact()
@@ -144,6 +161,41 @@ public:
 		db->CompactRange(options, nullptr, nullptr);
 	}
 
+	void checkpoint(const std::string& path) const
+	{
+		create_checkpoint(db, path);
+	}
+
+	uint32_t backup(const std::string& backup_dir, const uint32_t max_backups = 0) const
+	{
+		return create_backup(db, backup_dir, max_backups);
+	}
+
+	storage_stats_t get_storage_stats() const
+	{
+		return vnx::rocksdb::get_storage_stats(db);
+	}
+
+	uint64_t approx_count() const
+	{
+		return get_approx_count(db);
+	}
+
+	uint64_t approx_size() const
+	{
+		return get_approx_size(db);
+	}
+
+	uint64_t approx_range_size(const raw_data_t& begin, const raw_data_t& end) const
+	{
+		return get_approx_range_size(db, to_slice(begin), to_slice(end));
+	}
+
+	uint64_t count_range(const raw_data_t& begin, const raw_data_t& end) const
+	{
+		return get_range_count(db, to_slice(begin), to_slice(end));
+	}
+
 protected:
 	static ::rocksdb::Slice to_slice(const raw_data_t& data)
 	{
@@ -13,19 +13,27 @@
 #include <vnx/Output.hpp>
 #include <vnx/Memory.hpp>
 #include <vnx/Buffer.hpp>
+#include <vnx/rocksdb/util.h>
+#include <vnx/rocksdb/write_monitor.h>
 
 #include <rocksdb/db.h>
 #include <rocksdb/slice.h>
+#include <rocksdb/table.h>
 #include <rocksdb/options.h>
 #include <rocksdb/comparator.h>
+#include <rocksdb/write_batch.h>
 
 #include <limits>
+#include <type_traits>
 #include <atomic>
 
 
 namespace vnx {
 namespace rocksdb {
 
+template<typename K, typename V>
+class change_feed;
+
 enum key_mode_e {
 	EQUAL,
 	GREATER_EQUAL
@@ -70,6 +78,14 @@ protected:
 			return "vnx.rocksdb.table.Comparator";
 		}
 
+		/*
+		 * Integral keys have a canonical (fixed size) encoding, only then can the
+		 * data block hash index (kDataBlockBinaryAndHash) be used.
+		 */
+		bool CanKeysWithDifferentByteContentsBeEqual() const override {
+			return !std::is_integral<K>::value;
+		}
+
 		void FindShortestSeparator(std::string* start, const ::rocksdb::Slice& limit) const override {}
 		void FindShortSuccessor(std::string* key) const override {}
 
@@ -81,6 +97,8 @@ protected:
 public:
 	bool disable_type_codes = true;
 
+	std::shared_ptr<write_monitor> monitor;		// optional, needs to be set before open()
+
 	table() {
 		vnx::type<K>().create_dynamic_code(key_code);
 		vnx::type<V>().create_dynamic_code(value_code);
@@ -103,21 +121,35 @@ public:
 		close();
 		options.comparator = &comparator;
 		options.create_if_missing = true;
+		if(monitor) {
+			options.listeners.push_back(monitor);
+		}
 
 		const auto status = ::rocksdb::DB::Open(options, file_path, &db);
 		if(!status.ok()) {
 			throw std::runtime_error("DB::Open() failed with: " + status.ToString());
 		}
+		plain_table = is_plain_table(options);
+
+		if(monitor) {
+			monitor->attach(db);
+		}
 	}
 
 	void close()
 	{
+		if(monitor) {
+			monitor->attach(nullptr);
+		}
 		delete db;
 		db = nullptr;
 	}
 
 	void insert(const K& key, const V& value)
 	{
+		if(monitor) {
+			monitor->throttle();
+		}
 		stream_t key_stream(disable_type_codes);
 		stream_t value_stream(disable_type_codes);
 
@@ -131,6 +163,27 @@ public:
 		}
 	}
 
+	void insert_many(const std::vector<std::pair<K, V>>& entries)
+	{
+		if(monitor) {
+			monitor->throttle();
+		}
+		stream_t key_stream(disable_type_codes);
+		stream_t value_stream(disable_type_codes);
+
+		::rocksdb::WriteBatch batch;
+		for(const auto& entry : entries) {
+			batch.Put(	write(key_stream, entry.first, key_type, key_code),
+						write(value_stream, entry.second, value_type, value_code));
+		}
+		::rocksdb::WriteOptions options;
+		const auto status = db->Write(options, &batch);
+
+		if(!status.ok()) {
+			throw std::runtime_error("DB::Write() failed with: " + status.ToString());
+		}
+	}
+
 	bool find(const K& key) const
 	{
 		V dummy;
@@ -161,6 +214,35 @@ public:
 		return false;
 	}
 
+	size_t find_many(const std::vector<K>& keys, std::vector<bool>& found) const
+	{
+		std::vector<::rocksdb::PinnableSlice> pinned;
+		return multi_get(keys, pinned, found);
+	}
+
+	size_t find_many(const std::vector<K>& keys, std::vector<V>& values, std::vector<bool>& found) const
+	{
+		std::vector<::rocksdb::PinnableSlice> pinned;
+		multi_get(keys, pinned, found);
+
+		size_t count = 0;
+		values.clear();
+		values.resize(keys.size());
+		for(size_t i = 0; i < keys.size(); ++i) {
+			if(found[i]) {
+				try {
+					read(pinned[i], values[i], value_type, value_code);
+					count++;
+					continue;
+				} catch(...) {
+					// ignore
+				}
+				found[i] = false;
+			}
+		}
+		return count;
+	}
+
 	bool find_first(V& value) const
 	{
 		K dummy;
@@ -171,7 +253,7 @@ public:
 	{
 		key = K();
 		value = V();
-		::rocksdb::ReadOptions options;
+		const auto options = get_iter_options();
 		std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
 
 		iter->SeekToFirst();
@@ -183,6 +265,8 @@ public:
 			} catch(...) {
 				// ignore
 			}
+		} else {
+			check_status(iter.get());
 		}
 		return false;
 	}
@@ -193,11 +277,17 @@ public:
 		return find_last(dummy, value);
 	}
 
+	/*
+	 * Not supported with PlainTable (no SeekToLast()).
+	 */
 	bool find_last(K& key, V& value) const
 	{
+		if(plain_table) {
+			throw std::logic_error("table::find_last(): not supported with PlainTable");
+		}
 		key = K();
 		value = V();
-		::rocksdb::ReadOptions options;
+		const auto options = get_iter_options();
 		std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
 
 		iter->SeekToLast();
@@ -210,6 +300,7 @@ public:
 			}
 			return true;
 		}
+		check_status(iter.get());
 		return false;
 	}
 
@@ -217,7 +308,7 @@ public:
 	{
 		values.clear();
 
-		::rocksdb::ReadOptions options;
+		const auto options = get_iter_options(true);
 		std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
 
 		stream_t key_stream;
@@ -239,7 +330,7 @@ public:
 	{
 		values.clear();
 
-		::rocksdb::ReadOptions options;
+		const auto options = get_iter_options(true);
 		std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
 
 		stream_t key_stream;
@@ -260,7 +351,7 @@ public:
 
 	void scan(const std::function<void(const K&, const V&)>& callback) const
 	{
-		::rocksdb::ReadOptions options;
+		const auto options = get_iter_options(true);
 		std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
 
 		iter->SeekToFirst();
@@ -282,8 +373,33 @@ public:
 		}
 	}
 
+	void scan_keys(const std::function<void(const K&)>& callback) const
+	{
+		const auto options = get_iter_options(true);
+		std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
+
+		iter->SeekToFirst();
+		while(iter->Valid()) {
+			K key = K();
+			bool valid = false;
+			try {
+				read(iter->key(), key, key_type, key_code);
+				valid = true;
+			} catch(...) {
+				// ignore
+			}
+			if(valid) {
+				callback(key);
+			}
+			iter->Next();
+		}
+	}
+
 	bool erase(const K& key)
 	{
+		if(monitor) {
+			monitor->throttle();
+		}
 		stream_t key_stream(disable_type_codes);
 
 		::rocksdb::WriteOptions options;
@@ -298,28 +414,44 @@ public:
 		return true;
 	}
 
-	size_t erase_many(const std::vector<K>& keys)
+	/*
+	 * Returns number of keys erased, see erase_keys().
+	 */
+	size_t erase_many(const std::vector<K>& keys, const bool single_delete = false)
 	{
-		std::atomic<size_t> count {0};
 		if(keys.size() > size_t(std::numeric_limits<int>::max())) {
 			throw std::logic_error("keys.size() > INT_MAX");
 		}
-#pragma omp parallel for
-		for(int i = 0; i < int(keys.size()); ++i) {
-			try {
-				if(erase(keys[i])) {
-					count++;
+		std::vector<std::string> keys_(keys.size());
+
+#pragma omp parallel if(keys.size() >= 4096)
+		{
+			stream_t key_stream(disable_type_codes);
+#pragma omp for
+			for(int i = 0; i < int(keys.size()); ++i) {
+				try {
+					keys_[i] = write(key_stream, keys[i], key_type, key_code).ToString();
+				} catch(...) {
+					// ignore
 				}
-			} catch(...) {
-				// ignore
 			}
 		}
-		return count;
+		std::vector<::rocksdb::Slice> slices;
+		slices.reserve(keys_.size());
+		for(const auto& key : keys_) {
+			if(!key.empty()) {
+				slices.emplace_back(key);
+			}
+		}
+		if(monitor) {
+			monitor->throttle();
+		}
+		return erase_keys(db, std::move(slices), single_delete);
 	}
 
 	size_t erase_greater_equal(const K& key)
 	{
-		::rocksdb::ReadOptions options;
+		const auto options = get_iter_options(true);
 		std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
 
 		size_t count = 0;
@@ -336,7 +468,7 @@ public:
 
 	size_t truncate()
 	{
-		::rocksdb::ReadOptions options;
+		const auto options = get_iter_options(true);
 		std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
 
 		size_t count = 0;
@@ -365,7 +497,136 @@ public:
 		}
 	}
 
+	void checkpoint(const std::string& path) const
+	{
+		create_checkpoint(db, path);
+	}
+
+	uint32_t backup(const std::string& backup_dir, const uint32_t max_backups = 0) const
+	{
+		return create_backup(db, backup_dir, max_backups);
+	}
+
+	storage_stats_t get_storage_stats() const
+	{
+		return vnx::rocksdb::get_storage_stats(db);
+	}
+
+	/*
+	 * Returns the unique id of the database, which changes when it is re-created.
+	 */
+	std::string get_identity() const
+	{
+		std::string identity;
+		const auto status = db->GetDbIdentity(identity);
+		if(!status.ok()) {
+			throw std::runtime_error("DB::GetDbIdentity() failed with: " + status.ToString());
+		}
+		return identity;
+	}
+
+	uint64_t approx_count() const
+	{
+		return get_approx_count(db);
+	}
+
+	uint64_t approx_size() const
+	{
+		return get_approx_size(db);
+	}
+
+	/*
+	 * Estimated size in bytes of keys within [begin, end).
+	 */
+	uint64_t approx_range_size(const K& begin, const K& end) const
+	{
+		stream_t begin_stream(disable_type_codes);
+		stream_t end_stream(disable_type_codes);
+		return get_approx_range_size(db,
+				write(begin_stream, begin, key_type, key_code), write(end_stream, end, key_type, key_code));
+	}
+
+	/*
+	 * Estimated number of keys within [begin, end).
+	 */
+	uint64_t approx_range_count(const K& begin, const K& end) const
+	{
+		stream_t begin_stream(disable_type_codes);
+		stream_t end_stream(disable_type_codes);
+		return get_approx_range_count(db,
+				write(begin_stream, begin, key_type, key_code), write(end_stream, end, key_type, key_code));
+	}
+
+	/*
+	 * Exact number of keys within [begin, end), without decoding keys or values.
+	 */
+	uint64_t count_range(const K& begin, const K& end) const
+	{
+		stream_t begin_stream(disable_type_codes);
+		stream_t end_stream(disable_type_codes);
+		return get_range_count(db,
+				write(begin_stream, begin, key_type, key_code), write(end_stream, end, key_type, key_code));
+	}
+
 protected:
+	static bool is_plain_table(const ::rocksdb::Options& options)
+	{
+		return options.table_factory
+				&& std::string(options.table_factory->Name()) == ::rocksdb::TableFactory::kPlainTableName();
+	}
+
+	static void check_status(const ::rocksdb::Iterator* iter)
+	{
+		const auto status = iter->status();
+		if(!status.ok()) {
+			throw std::runtime_error("Iterator failed with: " + status.ToString());
+		}
+	}
+
+	static ::rocksdb::ReadOptions get_iter_options(const bool long_scan = false)
+	{
+		::rocksdb::ReadOptions options;
+		options.total_order_seek = true;		// in case a prefix extractor is set
+		if(long_scan) {
+			options.adaptive_readahead = true;
+			options.async_io = true;
+		}
+		return options;
+	}
+
+	size_t multi_get(const std::vector<K>& keys, std::vector<::rocksdb::PinnableSlice>& values, std::vector<bool>& found) const
+	{
+		std::vector<std::string> keys_(keys.size());
+		std::vector<::rocksdb::Slice> slices(keys.size());
+		{
+			stream_t key_stream(disable_type_codes);
+			for(size_t i = 0; i < keys.size(); ++i) {
+				keys_[i] = write(key_stream, keys[i], key_type, key_code).ToString();
+				slices[i] = keys_[i];
+			}
+		}
+		std::vector<::rocksdb::Status> status(keys.size());
+		values.clear();
+		values.resize(keys.size());
+
+		::rocksdb::ReadOptions options;
+		options.async_io = true;		// parallel reads with io_uring, if available
+		db->MultiGet(options, db->DefaultColumnFamily(), keys.size(), slices.data(), values.data(), status.data());
+
+		size_t count = 0;
+		found.clear();
+		found.resize(keys.size());
+		for(size_t i = 0; i < keys.size(); ++i) {
+			if(status[i].ok()) {
+				found[i] = true;
+				count++;
+			} else if(!status[i].IsNotFound()) {
+				throw std::runtime_error("DB::MultiGet() failed with: " + status[i].ToString());
+			}
+		}
+		return count;
+	}
+
 	template<typename T>
 	static void read(const ::rocksdb::Slice& slice, T& value, const vnx::TypeCode* type_code, const std::vector<uint16_t>& code)
 	{
@@ -393,6 +654,8 @@ protected:
 protected:
 	::rocksdb::DB* db = nullptr;
 
+	bool plain_table = false;
+
 	std::vector<uint16_t> key_code;
 	std::vector<uint16_t> value_code;
 
@@ -401,10 +664,30 @@ protected:
 
 	Comparator comparator;
 
+	friend class change_feed<K, V>;
+
 };
 
 
-void sync_type_codes(const std::string& file_path);
+/*
+ * Stores all known type codes in `file_path` and registers stored type codes which are not known yet.
+ * With `lazy` = true stored type codes are only registered on demand via load_type_code().
+ * A restart without new type codes only checks `file_path + ".manifest"` (hash over all stored type codes).
+ * With `lazy` = false the database is closed again before returning.
+ */
+void sync_type_codes(const std::string& file_path, const bool lazy = false);
+
+/*
+ * Returns registered type code for `code_hash`, loads and registers it from `file_path` if needed.
+ * Returns nullptr if not found.
+ */
+const vnx::TypeCode* load_type_code(const std::string& file_path, const vnx::Hash64& code_hash);
+
+/*
+ * Closes the database kept open by sync_type_codes(lazy = true) / load_type_code(),
+ * should be called before exit.
+ */
+void close_type_codes(const std::string& file_path);
 
 } // rocksdb
 } // vnx
@@ -0,0 +1,93 @@
+/*
+ * util.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#ifndef INCLUDE_VNX_ROCKSDB_UTIL_H_
+#define INCLUDE_VNX_ROCKSDB_UTIL_H_
+
+#include <rocksdb/db.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace vnx {
+namespace rocksdb {
+
+struct storage_stats_t {
+	uint64_t sst_bytes = 0;				// total size of SST files
+	uint64_t live_sst_bytes = 0;		// size of SST files in current version
+	uint64_t blob_bytes = 0;			// total size of blob files
+	uint64_t live_blob_bytes = 0;		// size of live data in blob files
+	uint64_t num_blob_files = 0;
+	uint64_t raw_data_bytes = 0;		// uncompressed size of keys + values in SST files
+	uint64_t data_bytes = 0;			// size of data blocks in SST files (after compression)
+
+	double compression_ratio() const {
+		return data_bytes ? double(raw_data_bytes) / data_bytes : 0;
+	}
+};
+
+/*
+ * Creates an openable snapshot of `db` at `path` (which must not exist yet).
+ * SST files are hard-linked when on the same file system, so this is near-instant.
+ */
+void create_checkpoint(::rocksdb::DB* db, const std::string& path);
+
+/*
+ * Creates a new incremental backup of `db` in `backup_dir`, only SST files not already
+ * contained in a previous backup are copied. Keeps at most `max_backups` (0 = unlimited).
+ * Returns the new backup id.
+ */
+uint32_t create_backup(::rocksdb::DB* db, const std::string& backup_dir, const uint32_t max_backups = 0);
+
+/*
+ * Restores the latest backup in `backup_dir` to `db_path` (database must be closed).
+ */
+void restore_backup(const std::string& backup_dir, const std::string& db_path);
+
+/*
+ * Deletes all existing `keys` in a single WriteBatch, existence is checked with a single MultiGet().
+ * Returns number of keys deleted (duplicate keys are counted per occurrence, unless `single_delete`).
+ * With `single_delete` = true uses SingleDelete() (duplicates removed), only valid for keys which were
+ * written once and never deleted via Delete().
+ */
+size_t erase_keys(::rocksdb::DB* db, std::vector<::rocksdb::Slice> keys, const bool single_delete = false);
+
+storage_stats_t get_storage_stats(::rocksdb::DB* db);
+
+/*
+ * Estimated number of keys in `db` (rocksdb.estimate-num-keys).
+ */
+uint64_t get_approx_count(::rocksdb::DB* db);
+
+/*
+ * Estimated size of `db` in bytes (live SST and blob files + memtables).
+ */
+uint64_t get_approx_size(::rocksdb::DB* db);
+
+/*
+ * Estimated size in bytes of keys within [begin, end), including memtables.
+ */
+uint64_t get_approx_range_size(::rocksdb::DB* db, const ::rocksdb::Slice& begin, const ::rocksdb::Slice& end);
+
+/*
+ * Estimated number of keys within [begin, end): approximate count in memtables
+ * plus SST size of the range divided by average SST entry size.
+ */
+uint64_t get_approx_range_count(::rocksdb::DB* db, const ::rocksdb::Slice& begin, const ::rocksdb::Slice& end);
+
+/*
+ * Exact number of keys within [begin, end), iterates keys only.
+ */
+uint64_t get_range_count(::rocksdb::DB* db, const ::rocksdb::Slice& begin, const ::rocksdb::Slice& end);
+
+
+} // rocksdb
+} // vnx
+
+#endif /* INCLUDE_VNX_ROCKSDB_UTIL_H_ */
@@ -0,0 +1,99 @@
+/*
+ * write_monitor.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#ifndef INCLUDE_VNX_ROCKSDB_WRITE_MONITOR_H_
+#define INCLUDE_VNX_ROCKSDB_WRITE_MONITOR_H_
+
+#include <rocksdb/db.h>
+#include <rocksdb/listener.h>
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+
+namespace vnx {
+namespace rocksdb {
+
+struct write_stats_t {
+	uint64_t pending_compaction_bytes = 0;
+	uint64_t num_l0_files = 0;
+	uint64_t num_running_flushes = 0;
+	uint64_t num_running_compactions = 0;
+	uint64_t delayed_write_rate = 0;			// [bytes/s], 0 if not delayed
+	bool is_stopped = false;
+	::rocksdb::WriteStallCondition condition = ::rocksdb::WriteStallCondition::kNormal;
+	uint64_t num_flushes = 0;
+	uint64_t num_compactions = 0;
+	uint64_t last_flush_ms = 0;					// duration of last flush
+	uint64_t last_compaction_ms = 0;			// duration of last compaction
+	uint64_t throttle_delay_us = 0;				// current delay per write
+	double pressure = 0;						// 1 = at slowdown trigger
+};
+
+/*
+ * Tracks write stall conditions, L0 files, pending compaction bytes and flush / compaction durations of a table.
+ * Optionally throttles writes before RocksDB has to slow down or stop them:
+ * once `pressure` exceeds `throttle_begin`, each write is delayed proportionally up to `max_delay_us`.
+ * Set as table::monitor before open().
+ */
+class write_monitor : public ::rocksdb::EventListener {
+public:
+	bool enable_throttle = false;
+	double throttle_begin = 0.5;				// relative to slowdown triggers
+	uint64_t max_delay_us = 10000;				// max delay per write
+	uint64_t sample_interval_us = 10000;		// how often to poll DB properties
+
+	std::function<void(const ::rocksdb::WriteStallCondition&)> on_stall;		// called on stall condition change
+
+	const char* Name() const override {
+		return "vnx.rocksdb.write_monitor";
+	}
+
+	void attach(::rocksdb::DB* db);
+
+	/*
+	 * Returns current stats, samples DB properties first if older than `sample_interval_us`.
+	 */
+	write_stats_t get_stats();
+
+	/*
+	 * Called before each write, blocks if throttling is needed.
+	 */
+	void throttle();
+
+	void OnStallConditionsChanged(const ::rocksdb::WriteStallInfo& info) override;
+
+	void OnFlushBegin(::rocksdb::DB* db, const ::rocksdb::FlushJobInfo& info) override;
+
+	void OnFlushCompleted(::rocksdb::DB* db, const ::rocksdb::FlushJobInfo& info) override;
+
+	void OnCompactionCompleted(::rocksdb::DB* db, const ::rocksdb::CompactionJobInfo& info) override;
+
+private:
+	void update(const int64_t now);
+
+private:
+	mutable std::mutex mutex;
+	::rocksdb::DB* db = nullptr;
+	write_stats_t stats;
+
+	uint64_t slowdown_l0_files = 0;
+	uint64_t soft_pending_bytes = 0;
+
+	std::map<int, int64_t> flush_begin;			// [job_id => begin time]
+	std::atomic<int64_t> last_update {0};
+	std::atomic<uint64_t> delay_us {0};
+
+};
+
+
+} // rocksdb
+} // vnx
+
+#endif /* INCLUDE_VNX_ROCKSDB_WRITE_MONITOR_H_ */
@@ -0,0 +1,143 @@
+/*
+ * options.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#include <vnx/rocksdb/options.h>
+
+#include <rocksdb/cache.h>
+#include <rocksdb/table.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
+
+
+namespace vnx {
+namespace rocksdb {
+
+::rocksdb::Options get_options(const profile_e profile, ::rocksdb::Options options, std::shared_ptr<::rocksdb::Cache> block_cache)
+{
+	// keep table options (and block cache) already set by the caller
+	::rocksdb::BlockBasedTableOptions table_options;
+	if(options.table_factory) {
+		if(auto factory = options.table_factory->GetOptions<::rocksdb::BlockBasedTableOptions>()) {
+			table_options = *factory;
+		}
+	}
+	if(block_cache) {
+		table_options.block_cache = block_cache;
+	}
+
+	switch(profile) {
+		case POINT_LOOKUP:
+			table_options.filter_policy.reset(::rocksdb::NewRibbonFilterPolicy(10));
+			table_options.optimize_filters_for_memory = true;
+			table_options.cache_index_and_filter_blocks = true;
+			table_options.pin_l0_filter_and_index_blocks_in_cache = true;
+			table_options.data_block_index_type = ::rocksdb::BlockBasedTableOptions::kDataBlockBinaryAndHash;
+			table_options.data_block_hash_table_util_ratio = 0.75;
+			break;
+		case APPEND_LOG:
+			options.compaction_style = ::rocksdb::kCompactionStyleUniversal;
+			options.write_buffer_size = 64 << 20;
+			options.max_write_buffer_number = 4;
+			options.level0_file_num_compaction_trigger = 8;
+			table_options.filter_policy.reset(::rocksdb::NewBloomFilterPolicy(10));
+			break;
+		case SCAN_HEAVY:
+			options.compaction_readahead_size = 2 << 20;
+			options.advise_random_on_open = false;
+			table_options.block_size = 64 * 1024;
+			break;
+		case SMALL_METADATA:
+			options.OptimizeForSmallDb();
+			options.keep_log_file_num = 3;
+			if(auto factory = options.table_factory->GetOptions<::rocksdb::BlockBasedTableOptions>()) {
+				table_options = *factory;		// OptimizeForSmallDb() sets a small block cache
+			}
+			if(block_cache) {
+				table_options.block_cache = block_cache;
+			}
+			table_options.filter_policy.reset(::rocksdb::NewBloomFilterPolicy(10));
+			table_options.cache_index_and_filter_blocks = true;
+			break;
+		case LARGE_VALUE:
+			options = enable_blob_files(options);
+			break;
+		case READ_MOSTLY:
+			return enable_plain_table(options);
+		default:
+			if(!block_cache) {
+				return options;
+			}
+	}
+	options.table_factory.reset(::rocksdb::NewBlockBasedTableFactory(table_options));
+	return options;
+}
+
+std::string get_profile_name(const profile_e profile)
+{
+	switch(profile) {
+		case DEFAULT_PROFILE: return "DEFAULT_PROFILE";
+		case POINT_LOOKUP: return "POINT_LOOKUP";
+		case APPEND_LOG: return "APPEND_LOG";
+		case SCAN_HEAVY: return "SCAN_HEAVY";
+		case SMALL_METADATA: return "SMALL_METADATA";
+		case LARGE_VALUE: return "LARGE_VALUE";
+		case READ_MOSTLY: return "READ_MOSTLY";
+	}
+	return "?";
+}
+
+::rocksdb::Options enable_blob_files(	::rocksdb::Options options, const uint64_t min_blob_size,
+										const ::rocksdb::CompressionType compression, const double gc_age_cutoff)
+{
+	options.enable_blob_files = true;
+	options.min_blob_size = min_blob_size;
+	options.blob_file_size = 256 << 20;
+	options.blob_compression_type = compression;
+	options.enable_blob_garbage_collection = true;
+	options.blob_garbage_collection_age_cutoff = gc_age_cutoff;
+	return options;
+}
+
+::rocksdb::Options enable_dict_compression(	::rocksdb::Options options, const uint32_t max_dict_bytes, const uint32_t train_factor)
+{
+	options.compression = ::rocksdb::kZSTD;
+	options.compression_opts.max_dict_bytes = max_dict_bytes;
+	options.compression_opts.zstd_max_train_bytes = uint64_t(max_dict_bytes) * train_factor;
+
+	options.bottommost_compression = ::rocksdb::kZSTD;
+	options.bottommost_compression_opts = options.compression_opts;
+	options.bottommost_compression_opts.enabled = true;
+	return options;
+}
+
+::rocksdb::Options enable_plain_table(::rocksdb::Options options, const uint32_t key_size, const bool hash_index)
+{
+	::rocksdb::PlainTableOptions table_options;
+	table_options.user_key_len = key_size ? key_size : ::rocksdb::kPlainTableVariableLength;
+	table_options.bloom_bits_per_key = 10;
+	table_options.hash_table_ratio = hash_index ? 0.75 : 0;
+	table_options.index_sparseness = hash_index ? 16 : 8;
+	table_options.store_index_in_file = true;
+
+	options.table_factory.reset(::rocksdb::NewPlainTableFactory(table_options));
+	options.allow_mmap_reads = true;
+	options.max_open_files = -1;
+	if(hash_index) {
+		options.prefix_extractor.reset(::rocksdb::NewNoopTransform());
+	}
+	return options;
+}
+
+::rocksdb::Options enable_wal_retention(::rocksdb::Options options, const uint64_t ttl_sec)
+{
+	options.WAL_ttl_seconds = ttl_sec;
+	return options;
+}
+
+
+} // rocksdb
+} // vnx
@@ -9,40 +9,181 @@
 
 #include <vnx/vnx.h>
 
+#include <map>
+#include <mutex>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+
 
 namespace vnx {
 namespace rocksdb {
 
-void sync_type_codes(const std::string& file_path)
+typedef table<Hash64, TypeCode> type_code_table_t;
+
+static std::mutex g_type_code_mutex;
+
+// never deleted, to avoid closing DBs during static destruction
+static auto* g_type_code_tables = new std::map<std::string, std::shared_ptr<type_code_table_t>>();
+
+static ::rocksdb::Options get_type_code_options()
 {
 	::rocksdb::Options options;
 	options.keep_log_file_num = 3;
 	options.OptimizeForSmallDb();
+	return options;
+}
+
+static std::shared_ptr<type_code_table_t> open_type_code_table(const std::string& file_path)
+{
+	auto table = std::make_shared<type_code_table_t>();
+	table->disable_type_codes = false;
+	table->open(file_path, get_type_code_options());
+	return table;
+}
 
-	table<Hash64, TypeCode> table(file_path, options);
-	table.disable_type_codes = false;
+/*
+ * Returns the shared handle for `file_path`, if `create` = true it is opened if needed.
+ */
+static std::shared_ptr<type_code_table_t> get_type_code_table(const std::string& file_path, const bool create)
+{
+	std::lock_guard<std::mutex> lock(g_type_code_mutex);
 
-	table.scan([](const Hash64& code_hash, const TypeCode& type_code) {
-		auto copy = std::make_shared<TypeCode>(type_code);
-		copy->build();
-		vnx::register_type_code(copy);
-	});
+	auto iter = g_type_code_tables->find(file_path);
+	if(iter != g_type_code_tables->end()) {
+		return iter->second;
+	}
+	if(!create) {
+		return nullptr;
+	}
+	const auto table = open_type_code_table(file_path);
+	(*g_type_code_tables)[file_path] = table;
+	return table;
+}
+
+static uint64_t get_manifest_hash(const std::vector<Hash64>& hashes)
+{
+	std::vector<uint64_t> sorted;
+	for(const auto& hash : hashes) {
+		sorted.push_back(uint64_t(hash));
+	}
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	std::string data;
+	data.reserve(sorted.size() * 8);
+	for(const auto value : sorted) {
+		data.append((const char*)&value, sizeof(value));
+	}
+	return uint64_t(Hash64(data));
+}
 
-	for(auto type_code : vnx::get_all_type_codes())
+/*
+ * The manifest stores a hash over all type codes in the DB, together with the DB identity,
+ * so that it does not match anymore once the DB is re-created.
+ */
+static bool check_manifest(const std::string& file_path, const std::string& identity, const uint64_t hash)
+{
+	std::string stored_identity;
+	uint64_t stored_hash = 0;
+	std::ifstream file(file_path + ".manifest");
+	if(file >> stored_identity >> stored_hash) {
+		return stored_identity == identity && stored_hash == hash;
+	}
+	return false;
+}
+
+static void write_manifest(const std::string& file_path, const std::string& identity, const uint64_t hash)
+{
+	const std::string path = file_path + ".manifest";
 	{
-		bool found = true;
-		try {
-			TypeCode tmp;
-			found = table.find(type_code->code_hash, tmp);
-		} catch(...) {
-			// not found
+		std::ofstream file(path + ".tmp", std::ios::trunc);
+		file << identity << " " << hash << std::endl;
+		if(!file) {
+			throw std::runtime_error("failed to write: " + path + ".tmp");
 		}
-		if(!found) {
-			table.insert(type_code->code_hash, *type_code);
+	}
+	if(std::rename((path + ".tmp").c_str(), path.c_str())) {
+		throw std::runtime_error("failed to rename: " + path + ".tmp");
+	}
+}
+
+static void register_stored(const type_code_table_t& table, const std::vector<Hash64>& code_hashes)
+{
+	std::vector<bool> found;
+	std::vector<TypeCode> type_codes;
+	table.find_many(code_hashes, type_codes, found);
+
+	for(size_t i = 0; i < type_codes.size(); ++i) {
+		if(found[i]) {
+			auto copy = std::make_shared<TypeCode>(std::move(type_codes[i]));
+			copy->build();
+			vnx::register_type_code(copy);
+		}
+	}
+}
+
+void sync_type_codes(const std::string& file_path, const bool lazy)
+{
+	// only the lazy mode keeps the DB open (for load_type_code())
+	auto table = get_type_code_table(file_path, lazy);
+	if(!table) {
+		table = open_type_code_table(file_path);
+	}
+	const auto identity = table->get_identity();
+
+	std::vector<Hash64> known;
+	std::map<uint64_t, const TypeCode*> known_map;
+	for(auto type_code : vnx::get_all_type_codes()) {
+		known.push_back(type_code->code_hash);
+		known_map[uint64_t(type_code->code_hash)] = &(*type_code);
+	}
+	if(check_manifest(file_path, identity, get_manifest_hash(known))) {
+		return;		// DB contains exactly the known type codes
+	}
+
+	std::vector<Hash64> stored;
+	table->scan_keys([&stored](const Hash64& code_hash) {
+		stored.push_back(code_hash);
+	});
+	if(!lazy) {
+		std::vector<Hash64> unknown;
+		for(const auto& code_hash : stored) {
+			if(!vnx::get_type_code(code_hash)) {
+				unknown.push_back(code_hash);
+			}
 		}
+		register_stored(*table, unknown);
+	}
+
+	for(const auto& code_hash : stored) {
+		known_map.erase(uint64_t(code_hash));
+	}
+	std::vector<std::pair<Hash64, TypeCode>> missing;
+	for(const auto& entry : known_map) {
+		missing.emplace_back(entry.second->code_hash, *entry.second);
+		stored.push_back(entry.second->code_hash);
+	}
+	table->insert_many(missing);
+
+	write_manifest(file_path, identity, get_manifest_hash(stored));
+}
+
+const TypeCode* load_type_code(const std::string& file_path, const Hash64& code_hash)
+{
+	if(auto type_code = vnx::get_type_code(code_hash)) {
+		return type_code;
 	}
+	register_stored(*get_type_code_table(file_path, true), {code_hash});
+
+	return vnx::get_type_code(code_hash);
 }
 
+void close_type_codes(const std::string& file_path)
+{
+	std::lock_guard<std::mutex> lock(g_type_code_mutex);
+	g_type_code_tables->erase(file_path);
+}
 
 } // rocksdb
 } // vnx
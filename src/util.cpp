@@ -0,0 +1,249 @@
+/*
+ * util.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#include <vnx/rocksdb/util.h>
+
+#include <rocksdb/utilities/checkpoint.h>
+#include <rocksdb/utilities/backup_engine.h>
+#include <rocksdb/write_batch.h>
+#include <rocksdb/table_properties.h>
+
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace vnx {
+namespace rocksdb {
+
+static std::unique_ptr<::rocksdb::BackupEngine> open_backup_engine(const std::string& backup_dir)
+{
+	::rocksdb::BackupEngine* engine = nullptr;
+	::rocksdb::BackupEngineOptions options(backup_dir);
+	options.share_table_files = true;
+
+	const auto status = ::rocksdb::BackupEngine::Open(options, ::rocksdb::Env::Default(), &engine);
+	if(!status.ok()) {
+		throw std::runtime_error("BackupEngine::Open() failed with: " + status.ToString());
+	}
+	return std::unique_ptr<::rocksdb::BackupEngine>(engine);
+}
+
+void create_checkpoint(::rocksdb::DB* db, const std::string& path)
+{
+	if(!db) {
+		throw std::logic_error("create_checkpoint(): db not open");
+	}
+	::rocksdb::Checkpoint* tmp = nullptr;
+	{
+		const auto status = ::rocksdb::Checkpoint::Create(db, &tmp);
+		if(!status.ok()) {
+			throw std::runtime_error("Checkpoint::Create() failed with: " + status.ToString());
+		}
+	}
+	std::unique_ptr<::rocksdb::Checkpoint> checkpoint(tmp);
+
+	const auto status = checkpoint->CreateCheckpoint(path);
+	if(!status.ok()) {
+		throw std::runtime_error("Checkpoint::CreateCheckpoint() failed with: " + status.ToString());
+	}
+}
+
+uint32_t create_backup(::rocksdb::DB* db, const std::string& backup_dir, const uint32_t max_backups)
+{
+	if(!db) {
+		throw std::logic_error("create_backup(): db not open");
+	}
+	const auto engine = open_backup_engine(backup_dir);
+
+	::rocksdb::BackupID backup_id = 0;
+	::rocksdb::CreateBackupOptions options;
+	options.flush_before_backup = true;
+	{
+		const auto status = engine->CreateNewBackup(options, db, &backup_id);
+		if(!status.ok()) {
+			throw std::runtime_error("BackupEngine::CreateNewBackup() failed with: " + status.ToString());
+		}
+	}
+	if(max_backups) {
+		const auto status = engine->PurgeOldBackups(max_backups);
+		if(!status.ok()) {
+			throw std::runtime_error("BackupEngine::PurgeOldBackups() failed with: " + status.ToString());
+		}
+	}
+	return backup_id;
+}
+
+void restore_backup(const std::string& backup_dir, const std::string& db_path)
+{
+	const auto engine = open_backup_engine(backup_dir);
+
+	const auto status = engine->RestoreDBFromLatestBackup(db_path, db_path);
+	if(!status.ok()) {
+		throw std::runtime_error("BackupEngine::RestoreDBFromLatestBackup() failed with: " + status.ToString());
+	}
+}
+
+size_t erase_keys(::rocksdb::DB* db, std::vector<::rocksdb::Slice> keys, const bool single_delete)
+{
+	if(keys.empty()) {
+		return 0;
+	}
+	if(single_delete) {
+		// multiple SingleDelete() of the same key in one batch are undefined (encoding is deterministic)
+		std::sort(keys.begin(), keys.end(),
+			[](const ::rocksdb::Slice& lhs, const ::rocksdb::Slice& rhs) -> bool {
+				return lhs.compare(rhs) < 0;
+			});
+		keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	}
+	std::vector<::rocksdb::PinnableSlice> values(keys.size());
+	std::vector<::rocksdb::Status> status(keys.size());
+	{
+		::rocksdb::ReadOptions options;
+		db->MultiGet(options, db->DefaultColumnFamily(), keys.size(), keys.data(), values.data(), status.data());
+	}
+	size_t count = 0;
+	::rocksdb::WriteBatch batch;
+	for(size_t i = 0; i < keys.size(); ++i) {
+		if(status[i].ok()) {
+			if(single_delete) {
+				batch.SingleDelete(keys[i]);
+			} else {
+				batch.Delete(keys[i]);
+			}
+			count++;
+		} else if(!status[i].IsNotFound()) {
+			throw std::runtime_error("DB::MultiGet() failed with: " + status[i].ToString());
+		}
+	}
+	if(count) {
+		::rocksdb::WriteOptions options;
+		const auto status = db->Write(options, &batch);
+		if(!status.ok()) {
+			throw std::runtime_error("DB::Write() failed with: " + status.ToString());
+		}
+	}
+	return count;
+}
+
+storage_stats_t get_storage_stats(::rocksdb::DB* db)
+{
+	if(!db) {
+		throw std::logic_error("get_storage_stats(): db not open");
+	}
+	storage_stats_t out;
+	db->GetIntProperty("rocksdb.total-sst-files-size", &out.sst_bytes);
+	db->GetIntProperty("rocksdb.live-sst-files-size", &out.live_sst_bytes);
+	db->GetIntProperty("rocksdb.total-blob-file-size", &out.blob_bytes);
+	db->GetIntProperty("rocksdb.live-blob-file-size", &out.live_blob_bytes);
+	db->GetIntProperty("rocksdb.num-blob-files", &out.num_blob_files);
+
+	::rocksdb::TablePropertiesCollection props;
+	if(db->GetPropertiesOfAllTables(&props).ok()) {
+		for(const auto& entry : props) {
+			out.raw_data_bytes += entry.second->raw_key_size + entry.second->raw_value_size;
+			out.data_bytes += entry.second->data_size;
+		}
+	}
+	return out;
+}
+
+uint64_t get_approx_count(::rocksdb::DB* db)
+{
+	uint64_t count = 0;
+	db->GetIntProperty("rocksdb.estimate-num-keys", &count);
+	return count;
+}
+
+uint64_t get_approx_size(::rocksdb::DB* db)
+{
+	uint64_t sst_size = 0;
+	uint64_t blob_size = 0;
+	uint64_t mem_size = 0;
+	db->GetIntProperty("rocksdb.live-sst-files-size", &sst_size);
+	db->GetIntProperty("rocksdb.live-blob-file-size", &blob_size);
+	db->GetIntProperty("rocksdb.cur-size-all-mem-tables", &mem_size);
+	return sst_size + blob_size + mem_size;
+}
+
+uint64_t get_approx_range_size(::rocksdb::DB* db, const ::rocksdb::Slice& begin, const ::rocksdb::Slice& end)
+{
+	uint64_t size = 0;
+	const ::rocksdb::Range range(begin, end);
+
+	::rocksdb::SizeApproximationOptions options;
+	options.include_memtables = true;
+	options.include_files = true;
+
+	const auto status = db->GetApproximateSizes(options, db->DefaultColumnFamily(), &range, 1, &size);
+	if(!status.ok()) {
+		throw std::runtime_error("DB::GetApproximateSizes() failed with: " + status.ToString());
+	}
+	return size;
+}
+
+uint64_t get_approx_range_count(::rocksdb::DB* db, const ::rocksdb::Slice& begin, const ::rocksdb::Slice& end)
+{
+	const ::rocksdb::Range range(begin, end);
+
+	uint64_t mem_count = 0;
+	uint64_t mem_size = 0;
+	db->GetApproximateMemTableStats(db->DefaultColumnFamily(), range, &mem_count, &mem_size);
+
+	uint64_t file_size = 0;
+	::rocksdb::SizeApproximationOptions options;
+	options.include_memtables = false;
+	options.include_files = true;
+
+	const auto status = db->GetApproximateSizes(options, db->DefaultColumnFamily(), &range, 1, &file_size);
+	if(!status.ok()) {
+		throw std::runtime_error("DB::GetApproximateSizes() failed with: " + status.ToString());
+	}
+	uint64_t num_entries = 0;
+	uint64_t num_mem_entries = 0;
+	uint64_t num_imm_entries = 0;
+	uint64_t total_size = 0;
+	db->GetIntProperty("rocksdb.estimate-num-keys", &num_entries);
+	db->GetIntProperty("rocksdb.num-entries-active-mem-table", &num_mem_entries);
+	db->GetIntProperty("rocksdb.num-entries-imm-mem-tables", &num_imm_entries);
+	db->GetIntProperty("rocksdb.live-sst-files-size", &total_size);
+
+	// estimate-num-keys includes memtables, only SST entries are relevant here
+	const uint64_t num_file_entries =
+			num_entries > num_mem_entries + num_imm_entries ? num_entries - (num_mem_entries + num_imm_entries) : 0;
+
+	uint64_t file_count = 0;
+	if(num_file_entries && total_size) {
+		file_count = uint64_t(double(file_size) * (double(num_file_entries) / total_size));
+	}
+	return mem_count + file_count;
+}
+
+uint64_t get_range_count(::rocksdb::DB* db, const ::rocksdb::Slice& begin, const ::rocksdb::Slice& end)
+{
+	::rocksdb::ReadOptions options;
+	options.total_order_seek = true;
+	options.adaptive_readahead = true;
+	options.async_io = true;
+	options.iterate_upper_bound = &end;
+	std::unique_ptr<::rocksdb::Iterator> iter(db->NewIterator(options));
+
+	uint64_t count = 0;
+	for(iter->Seek(begin); iter->Valid(); iter->Next()) {
+		count++;
+	}
+	const auto status = iter->status();
+	if(!status.ok()) {
+		throw std::runtime_error("Iterator failed with: " + status.ToString());
+	}
+	return count;
+}
+
+
+} // rocksdb
+} // vnx
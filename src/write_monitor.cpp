@@ -0,0 +1,134 @@
+/*
+ * write_monitor.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#include <vnx/rocksdb/write_monitor.h>
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+
+namespace vnx {
+namespace rocksdb {
+
+static int64_t get_time_us()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void write_monitor::attach(::rocksdb::DB* db_)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	db = db_;
+	stats = write_stats_t();
+	flush_begin.clear();
+	last_update = 0;
+	delay_us = 0;
+	if(db) {
+		const auto options = db->GetOptions();
+		slowdown_l0_files = std::max(options.level0_slowdown_writes_trigger, 1);
+		soft_pending_bytes = options.soft_pending_compaction_bytes_limit;
+	}
+}
+
+write_stats_t write_monitor::get_stats()
+{
+	const auto now = get_time_us();
+	if(now - last_update >= int64_t(sample_interval_us)) {
+		update(now);
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	auto out = stats;
+	out.throttle_delay_us = delay_us;
+	return out;
+}
+
+void write_monitor::throttle()
+{
+	const auto now = get_time_us();
+	if(now - last_update >= int64_t(sample_interval_us)) {
+		update(now);
+	}
+	if(const auto delay = delay_us.load()) {
+		std::this_thread::sleep_for(std::chrono::microseconds(delay));
+	}
+}
+
+void write_monitor::update(const int64_t now)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if(!db || now - last_update < int64_t(sample_interval_us)) {
+		return;
+	}
+	last_update = now;
+
+	uint64_t is_stopped = 0;
+	db->GetIntProperty("rocksdb.estimate-pending-compaction-bytes", &stats.pending_compaction_bytes);
+	db->GetIntProperty("rocksdb.num-files-at-level0", &stats.num_l0_files);
+	db->GetIntProperty("rocksdb.num-running-flushes", &stats.num_running_flushes);
+	db->GetIntProperty("rocksdb.num-running-compactions", &stats.num_running_compactions);
+	db->GetIntProperty("rocksdb.actual-delayed-write-rate", &stats.delayed_write_rate);
+	db->GetIntProperty("rocksdb.is-write-stopped", &is_stopped);
+	stats.is_stopped = is_stopped;
+
+	double pressure = double(stats.num_l0_files) / slowdown_l0_files;
+	if(soft_pending_bytes) {
+		pressure = std::max(pressure, double(stats.pending_compaction_bytes) / soft_pending_bytes);
+	}
+	stats.pressure = pressure;
+
+	uint64_t delay = 0;
+	if(enable_throttle) {
+		if(stats.is_stopped || stats.condition != ::rocksdb::WriteStallCondition::kNormal) {
+			delay = max_delay_us;
+		} else if(pressure > throttle_begin && throttle_begin < 1) {
+			delay = max_delay_us * std::min((pressure - throttle_begin) / (1 - throttle_begin), 1.);
+		}
+	}
+	delay_us = delay;
+}
+
+void write_monitor::OnStallConditionsChanged(const ::rocksdb::WriteStallInfo& info)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stats.condition = info.condition.cur;
+		last_update = 0;		// update on next write
+	}
+	if(on_stall) {
+		on_stall(info.condition.cur);
+	}
+}
+
+void write_monitor::OnFlushBegin(::rocksdb::DB* db_, const ::rocksdb::FlushJobInfo& info)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	flush_begin[info.job_id] = get_time_us();
+}
+
+void write_monitor::OnFlushCompleted(::rocksdb::DB* db_, const ::rocksdb::FlushJobInfo& info)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	stats.num_flushes++;
+	auto iter = flush_begin.find(info.job_id);
+	if(iter != flush_begin.end()) {
+		stats.last_flush_ms = (get_time_us() - iter->second) / 1000;
+		flush_begin.erase(iter);
+	}
+}
+
+void write_monitor::OnCompactionCompleted(::rocksdb::DB* db_, const ::rocksdb::CompactionJobInfo& info)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	stats.num_compactions++;
+	stats.last_compaction_ms = info.stats.elapsed_micros / 1000;
+}
+
+
+} // rocksdb
+} // vnx
@@ -0,0 +1,194 @@
+/*
+ * bench_table.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#include <vnx/rocksdb/table.h>
+#include <vnx/rocksdb/multi_table.h>
+#include <vnx/rocksdb/options.h>
+
+#include <vnx/vnx.h>
+
+#include <chrono>
+#include <random>
+
+
+static const auto g_block_cache = ::rocksdb::NewLRUCache(128 << 20);		// shared by all tables
+
+static int64_t get_time_ms()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void bench_profile(const vnx::rocksdb::profile_e profile, const size_t num_keys, const size_t num_lookups, const size_t num_ranges)
+{
+	const auto name = vnx::rocksdb::get_profile_name(profile);
+
+	vnx::rocksdb::table<uint64_t, std::string> table("bench_" + name, vnx::rocksdb::get_options(profile, ::rocksdb::Options(), g_block_cache));
+	table.truncate();
+	{
+		const auto time_begin = get_time_ms();
+		std::vector<std::pair<uint64_t, std::string>> batch;
+		for(size_t i = 0; i < num_keys; ++i) {
+			batch.emplace_back(i * 2, std::string(100, char('a' + i % 26)));
+			if(batch.size() >= 10000) {
+				table.insert_many(batch);
+				batch.clear();
+			}
+		}
+		table.insert_many(batch);
+		table.flush();
+		table.compact();
+		std::cout << name << ": insert took " << (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+	{
+		std::mt19937_64 generator(1337);
+		const auto time_begin = get_time_ms();
+		size_t num_found = 0;
+		for(size_t i = 0; i < num_lookups; ++i) {
+			// odd keys never exist
+			if(table.find(generator() % (num_keys * 2))) {
+				num_found++;
+			}
+		}
+		std::cout << name << ": " << num_lookups << " lookups (" << num_found << " found) took "
+				<< (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+	{
+		std::mt19937_64 generator(1337);
+		const auto time_begin = get_time_ms();
+		size_t num_rows = 0;
+		for(size_t i = 0; i < num_ranges; ++i) {
+			const uint64_t begin = generator() % (num_keys * 2);
+			num_rows += table.count_range(begin, begin + 2000);
+		}
+		std::cout << name << ": " << num_ranges << " range scans (" << num_rows << " rows) took "
+				<< (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+	{
+		const auto time_begin = get_time_ms();
+		size_t num_rows = 0;
+		table.scan([&num_rows](const uint64_t& key, const std::string& value) {
+			num_rows++;
+		});
+		std::cout << name << ": scan of " << num_rows << " rows took " << (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+}
+
+static void bench_multi_profile(const vnx::rocksdb::profile_e profile, const size_t num_keys, const size_t num_values, const size_t num_ranges)
+{
+	const auto name = vnx::rocksdb::get_profile_name(profile);
+
+	vnx::rocksdb::multi_table<uint64_t, std::string> table("bench_multi_" + name, vnx::rocksdb::get_options(profile, ::rocksdb::Options(), g_block_cache));
+	table.truncate();
+	{
+		// append to all keys in turns, like a log per key
+		const auto time_begin = get_time_ms();
+		const std::vector<std::string> values(10, std::string(100, 'x'));
+		for(size_t k = 0; k < num_values; k += values.size()) {
+			for(size_t i = 0; i < num_keys; ++i) {
+				table.insert_many(i, values);
+			}
+		}
+		table.flush();
+		table.compact();
+		std::cout << name << ": multi_table append of " << num_keys * num_values << " values took "
+				<< (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+	{
+		std::mt19937_64 generator(1337);
+		const auto time_begin = get_time_ms();
+		size_t num_rows = 0;
+		std::vector<std::string> values;
+		for(size_t i = 0; i < num_ranges; ++i) {
+			num_rows += table.find(generator() % num_keys, values);
+		}
+		std::cout << name << ": multi_table " << num_ranges << " key lookups (" << num_rows << " rows) took "
+				<< (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+	{
+		std::mt19937_64 generator(1337);
+		const auto time_begin = get_time_ms();
+		size_t num_rows = 0;
+		std::vector<std::string> values;
+		for(size_t i = 0; i < num_ranges; ++i) {
+			const uint64_t begin = generator() % num_keys;
+			num_rows += table.find_range(begin, begin + 10, values);
+		}
+		std::cout << name << ": multi_table " << num_ranges << " range scans (" << num_rows << " rows) took "
+				<< (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+}
+
+static void bench_erase_many(const size_t num_keys)
+{
+	vnx::rocksdb::table<uint64_t, std::string> table("bench_erase_many");
+	table.truncate();
+
+	std::vector<uint64_t> keys;
+	std::vector<std::pair<uint64_t, std::string>> entries;
+	for(size_t i = 0; i < num_keys; ++i) {
+		keys.push_back(i);
+		entries.emplace_back(i, std::string(100, 'x'));
+	}
+	{
+		table.insert_many(entries);
+		const auto time_begin = get_time_ms();
+#pragma omp parallel for
+		for(int i = 0; i < int(keys.size()); ++i) {
+			table.erase(keys[i]);
+		}
+		std::cout << "erase() loop: " << num_keys << " keys took " << (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+	{
+		table.insert_many(entries);
+		const auto time_begin = get_time_ms();
+		const auto count = table.erase_many(keys);
+		std::cout << "erase_many(): " << count << " keys took " << (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+	{
+		// SingleDelete() must not be mixed with Delete() on the same key, so use a separate table
+		// and compact away the tombstones of truncate() from a previous run
+		vnx::rocksdb::table<uint64_t, std::string> table("bench_erase_many_single");
+		table.truncate();
+		table.flush();
+		table.compact();
+
+		table.insert_many(entries);
+		const auto time_begin = get_time_ms();
+		const auto count = table.erase_many(keys, true);
+		std::cout << "erase_many(single_delete): " << count << " keys took " << (get_time_ms() - time_begin) << " ms" << std::endl;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	vnx::init("bench_table", argc, argv);
+
+	const size_t num_keys = 1000000;
+	const size_t num_lookups = 1000000;
+	const size_t num_ranges = 10000;
+
+	for(const auto profile : {
+			vnx::rocksdb::DEFAULT_PROFILE, vnx::rocksdb::POINT_LOOKUP, vnx::rocksdb::APPEND_LOG,
+			vnx::rocksdb::SCAN_HEAVY, vnx::rocksdb::SMALL_METADATA, vnx::rocksdb::READ_MOSTLY})
+	{
+		bench_profile(profile, num_keys, num_lookups, num_ranges);
+	}
+	// PlainTable (READ_MOSTLY) does not support multi_table
+	for(const auto profile : {
+			vnx::rocksdb::DEFAULT_PROFILE, vnx::rocksdb::POINT_LOOKUP, vnx::rocksdb::APPEND_LOG,
+			vnx::rocksdb::SCAN_HEAVY, vnx::rocksdb::SMALL_METADATA})
+	{
+		bench_multi_profile(profile, 10000, 100, num_ranges);
+	}
+	bench_erase_many(num_keys);
+
+	vnx::close();
+
+	return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * test_concurrency.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: mad
+ */
+
+#include <vnx/rocksdb/table.h>
+#include <vnx/rocksdb/multi_table.h>
+
+#include <vnx/vnx.h>
+
+#include <map>
+#include <set>
+#include <thread>
+#include <chrono>
+#include <random>
+
+
+static std::atomic<size_t> num_errors {0};
+
+static void check(const bool cond, const std::string& what)
+{
+	if(!cond) {
+		if(num_errors++ < 10) {
+			std::cerr << "FAILED: " << what << std::endl;
+		}
+	}
+}
+
+static double get_time_sec()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count() * 1e-6;
+}
+
+template<typename F>
+static double run_threads(const int num_threads, const F& func)
+{
+	const auto time_begin = get_time_sec();
+	std::vector<std::thread> threads;
+	for(int i = 0; i < num_threads; ++i) {
+		threads.emplace_back(func, i);
+	}
+	for(auto& thread : threads) {
+		thread.join();
+	}
+	return get_time_sec() - time_begin;
+}
+
+/*
+ * Each thread owns keys with (key % num_threads == thread) and checks them against its own model.
+ * Scans run on the whole table concurrently.
+ */
+static double test_table(const int num_threads, const size_t total_ops)
+{
+	vnx::rocksdb::table<uint64_t, uint64_t> table("test_concurrency_table");
+	table.truncate();
+
+	std::vector<std::map<uint64_t, uint64_t>> models(num_threads);
+
+	const auto elapsed = run_threads(num_threads, [&](const int index) {
+		auto& model = models[index];
+		std::mt19937_64 generator(index);
+		for(size_t i = 0; i < total_ops / num_threads; ++i) {
+			const uint64_t key = (generator() % 10000) * num_threads + index;
+			const auto op = generator() % 100;
+			if(op < 40) {
+				table.insert(key, i);
+				model[key] = i;
+			} else if(op < 60) {
+				table.erase(key);
+				model.erase(key);
+			} else if(op < 95) {
+				uint64_t value = 0;
+				const auto found = table.find(key, value);
+				const auto iter = model.find(key);
+				check(found == (iter != model.end()), "table::find() found");
+				check(!found || value == iter->second, "table::find() value");
+			} else {
+				size_t count = 0;
+				table.scan([&count](const uint64_t& key, const uint64_t& value) {
+					count++;
+				});
+			}
+		}
+	});
+
+	std::map<uint64_t, uint64_t> model;
+	for(const auto& entry : models) {
+		model.insert(entry.begin(), entry.end());
+	}
+	std::map<uint64_t, uint64_t> result;
+	table.scan([&result](const uint64_t& key, const uint64_t& value) {
+		result[key] = value;
+	});
+	check(result == model, "table final state");
+
+	return total_ops / elapsed;
+}
+
+/*
+ * Threads append to shared hot keys (checked for lost updates at the end),
+ * and insert / erase / query their own key range against a model.
+ */
+static double test_multi_table(const int num_threads, const size_t total_ops)
+{
+	const uint64_t num_shared = 16;
+	const uint64_t range_size = 1000;
+
+	vnx::rocksdb::multi_table<uint64_t, uint64_t> table("test_concurrency_multi_table");
+	table.truncate();
+
+	std::vector<size_t> num_appends(num_threads);
+	std::vector<std::map<uint64_t, std::vector<uint64_t>>> models(num_threads);
+
+	const auto elapsed = run_threads(num_threads, [&](const int index) {
+		auto& model = models[index];
+		std::mt19937_64 generator(index);
+		const uint64_t base = num_shared + index * range_size;
+
+		for(size_t i = 0; i < total_ops / num_threads; ++i) {
+			const uint64_t key = base + generator() % range_size;
+			const auto op = generator() % 100;
+			if(op < 20) {
+				table.insert(generator() % num_shared, (uint64_t(index) << 32) | num_appends[index]++);
+			} else if(op < 50) {
+				table.insert(key, i);
+				model[key].push_back(i);
+			} else if(op < 55) {
+				table.erase_all(key);
+				model.erase(key);
+			} else if(op < 57) {
+				const auto end = std::min(key + 10, base + range_size);
+				table.erase_range(key, end);
+				model.erase(model.lower_bound(key), model.lower_bound(end));
+			} else if(op < 90) {
+				std::vector<uint64_t> values;
+				table.find(key, values);
+				const auto iter = model.find(key);
+				check(iter == model.end() ? values.empty() : values == iter->second, "multi_table::find()");
+			} else {
+				const auto end = std::min(key + 10, base + range_size);
+				std::vector<uint64_t> values;
+				std::vector<uint64_t> expected;
+				table.find_range(key, end, values);
+				for(auto iter = model.lower_bound(key); iter != model.lower_bound(end); ++iter) {
+					expected.insert(expected.end(), iter->second.begin(), iter->second.end());
+				}
+				check(values == expected, "multi_table::find_range()");
+			}
+		}
+	});
+
+	std::set<uint64_t> appended;
+	for(uint64_t key = 0; key < num_shared; ++key) {
+		std::vector<uint64_t> values;
+		table.find(key, values);
+		appended.insert(values.begin(), values.end());
+	}
+	size_t total_appends = 0;
+	for(const auto count : num_appends) {
+		total_appends += count;
+	}
+	check(appended.size() == total_appends, "multi_table lost appends");
+
+	return total_ops / elapsed;
+}
+
+
+int main(int argc, char** argv)
+{
+	vnx::init("test_concurrency", argc, argv);
+
+	const size_t total_ops = 200000;
+
+	std::cout << "threads, table [ops/s], multi_table [ops/s]" << std::endl;
+
+	for(int num_threads = 1; num_threads <= 64; num_threads *= 2) {
+		const auto table_rate = test_table(num_threads, total_ops);
+		const auto multi_rate = test_multi_table(num_threads, total_ops);
+		std::cout << num_threads << ", " << size_t(table_rate) << ", " << size_t(multi_rate) << std::endl;
+	}
+
+	vnx::close();
+
+	if(num_errors) {
+		std::cerr << num_errors << " errors" << std::endl;
+		return 1;
+	}
+	return 0;
+}
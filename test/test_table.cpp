@@ -7,6 +7,9 @@
 
 #include <vnx/rocksdb/table.h>
 #include <vnx/rocksdb/multi_table.h>
+#include <vnx/rocksdb/packed_multi_table.h>
+#include <vnx/rocksdb/change_feed.h>
+#include <vnx/rocksdb/options.h>
 
 #include <vnx/vnx.h>
 #include <vnx/record_index_entry_t.hxx>
@@ -69,6 +72,62 @@ int main(int argc, char** argv)
 		} else {
 			std::cout << "values = NOT FOUND" << std::endl;
 		}
+		std::cout << "count(1337) = " << table.count(1337) << ", approx_count(1337) = " << table.approx_count(1337) << std::endl;
+	}
+	{
+		vnx::rocksdb::packed_multi_table<uint64_t, std::string> table("test_packed_multi_table");
+		table.chunk_size = 2;
+
+		table.truncate();
+		table.insert(1337, "test1");
+		table.insert_many(1337, {"test2", "test3"});
+		table.insert(1338, "test4");
+		table.repack(1337);
+		table.insert(1337, "test5");
+
+		std::vector<std::string> values;
+		if(table.find(1337, values)) {
+			std::cout << "values = " << vnx::to_string(values) << std::endl;
+		} else {
+			std::cout << "values = NOT FOUND" << std::endl;
+		}
+		if(table.find_last(1337, values, 2)) {
+			std::cout << "values = " << vnx::to_string(values) << std::endl;
+		} else {
+			std::cout << "values = NOT FOUND" << std::endl;
+		}
+	}
+	{
+		typedef vnx::rocksdb::change_feed<uint64_t, std::string> feed_t;
+
+		const auto print = [](const std::vector<feed_t::change_t>& changes) {
+			for(const auto& change : changes) {
+				std::cout << "change: sequence = " << change.sequence << ", erase = " << change.erase
+						<< ", key = " << change.key << ", value = " << vnx::to_string(change.value) << std::endl;
+			}
+		};
+		const auto options = vnx::rocksdb::enable_wal_retention(::rocksdb::Options());
+		std::remove("test_change_feed.cursor");
+		{
+			vnx::rocksdb::table<uint64_t, std::string> table("test_change_feed", options);
+			feed_t feed(table, "test_change_feed.cursor", true);
+			feed.max_batch_size = 2;
+
+			table.insert(1, "test1");
+			table.insert_many({{2, "test2"}, {3, "test3"}, {4, "test4"}});
+			table.erase(2);
+
+			std::cout << "poll() = " << feed.poll(print) << std::endl;
+			std::cout << "poll() = " << feed.poll(print) << " (nothing new)" << std::endl;
+
+			table.insert(5, "test5");
+		}
+		{
+			vnx::rocksdb::table<uint64_t, std::string> table("test_change_feed", options);
+			feed_t feed(table, "test_change_feed.cursor");
+
+			std::cout << "poll() after reopen = " << feed.poll(print) << std::endl;
+		}
 	}
 
 	vnx::close();